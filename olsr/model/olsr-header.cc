@@ -21,12 +21,17 @@
 
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/packet.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #define IPV4_ADDRESS_SIZE 4
 #define OLSR_MSG_HEADER_SIZE 12
 #define OLSR_PKT_HEADER_SIZE 4
+#define OLSR_POSITION_WORDS_SIZE 8
+#define OLSR_VELOCITY_WORDS_SIZE 8
 
 namespace ns3
 {
@@ -38,6 +43,8 @@ namespace olsr
 
 /// Scaling factor used in RFC 3626.
 #define OLSR_C 0.0625
+/// Resolution of the velocities carried in HELLO and TC messages, in m/s.
+#define OLSR_VELOCITY_RESOLUTION 0.01
 
 ///
 /// \brief Converts a decimal number of seconds to the mantissa/exponent format.
@@ -101,6 +108,78 @@ EmfToSeconds(uint8_t olsrFormat)
     return OLSR_C * (1 + a / 16.0) * (1 << b);
 }
 
+///
+/// \brief Converts a coordinate to the fixed point format used in HELLO and TC messages.
+///
+/// \param coordinate the coordinate, in meters.
+/// \param origin the coordinate of the area origin, in meters.
+/// \param resolution the size of one fixed point step, in meters.
+/// \return the coordinate in fixed point format.
+///
+uint16_t
+CoordinateToFixed(double coordinate, double origin, double resolution)
+{
+    NS_ASSERT(resolution > 0);
+
+    double steps = std::round((coordinate - origin) / resolution);
+    if (steps < 0)
+    {
+        NS_LOG_WARN("CoordinateToFixed - " << coordinate << " is below the area origin, clamping");
+        return 0;
+    }
+    if (steps > std::numeric_limits<uint16_t>::max())
+    {
+        NS_LOG_WARN("CoordinateToFixed - " << coordinate << " is outside the area, clamping");
+        return std::numeric_limits<uint16_t>::max();
+    }
+    return static_cast<uint16_t>(steps);
+}
+
+///
+/// \brief Converts a coordinate in fixed point format back to meters.
+///
+/// \param fixed the coordinate in fixed point format.
+/// \param origin the coordinate of the area origin, in meters.
+/// \param resolution the size of one fixed point step, in meters.
+/// \return the coordinate, in meters.
+///
+double
+FixedToCoordinate(uint16_t fixed, double origin, double resolution)
+{
+    return origin + fixed * resolution;
+}
+
+///
+/// \brief Converts a velocity component to the format used in HELLO and TC messages.
+///
+/// \param velocity the velocity component, in m/s.
+/// \return the velocity component, in cm/s.
+///
+int16_t
+VelocityToFixed(double velocity)
+{
+    double steps = std::round(velocity / OLSR_VELOCITY_RESOLUTION);
+    if (steps < std::numeric_limits<int16_t>::min() || steps > std::numeric_limits<int16_t>::max())
+    {
+        NS_LOG_WARN("VelocityToFixed - " << velocity << " m/s is out of range, clamping");
+        return steps < 0 ? std::numeric_limits<int16_t>::min()
+                         : std::numeric_limits<int16_t>::max();
+    }
+    return static_cast<int16_t>(steps);
+}
+
+///
+/// \brief Converts a velocity component in cm/s back to m/s.
+///
+/// \param fixed the velocity component, in cm/s.
+/// \return the velocity component, in m/s.
+///
+double
+FixedToVelocity(int16_t fixed)
+{
+    return fixed * OLSR_VELOCITY_RESOLUTION;
+}
+
 // ---------------- OLSR Packet -------------------------------
 
 NS_OBJECT_ENSURE_REGISTERED(PacketHeader);
@@ -187,6 +266,47 @@ MessageHeader::GetInstanceTypeId() const
     return GetTypeId();
 }
 
+void
+MessageHeader::SetMessageType(MessageType messageType)
+{
+    m_messageType = messageType;
+    EnsureMessage();
+}
+
+void
+MessageHeader::EnsureMessage()
+{
+    switch (m_messageType)
+    {
+    case MID_MESSAGE:
+        if (!std::holds_alternative<Mid>(m_message))
+        {
+            m_message.emplace<Mid>();
+        }
+        break;
+    case HELLO_MESSAGE:
+        if (!std::holds_alternative<Hello>(m_message))
+        {
+            m_message.emplace<Hello>();
+        }
+        break;
+    case TC_MESSAGE:
+        if (!std::holds_alternative<Tc>(m_message))
+        {
+            m_message.emplace<Tc>();
+        }
+        break;
+    case HNA_MESSAGE:
+        if (!std::holds_alternative<Hna>(m_message))
+        {
+            m_message.emplace<Hna>();
+        }
+        break;
+    default:
+        m_message.emplace<std::monostate>();
+    }
+}
+
 uint32_t
 MessageHeader::GetSerializedSize() const
 {
@@ -194,18 +314,18 @@ MessageHeader::GetSerializedSize() const
     switch (m_messageType)
     {
     case MID_MESSAGE:
-        size += m_message.mid.GetSerializedSize();
+        size += std::get<Mid>(m_message).GetSerializedSize();
         break;
     case HELLO_MESSAGE:
         NS_LOG_DEBUG("Hello Message Size: " << size << " + "
-                                            << m_message.hello.GetSerializedSize());
-        size += m_message.hello.GetSerializedSize();
+                                            << std::get<Hello>(m_message).GetSerializedSize());
+        size += std::get<Hello>(m_message).GetSerializedSize();
         break;
     case TC_MESSAGE:
-        size += m_message.tc.GetSerializedSize();
+        size += std::get<Tc>(m_message).GetSerializedSize();
         break;
     case HNA_MESSAGE:
-        size += m_message.hna.GetSerializedSize();
+        size += std::get<Hna>(m_message).GetSerializedSize();
         break;
     default:
         NS_ASSERT(false);
@@ -242,16 +362,16 @@ MessageHeader::Print(std::ostream& os) const
     switch (m_messageType)
     {
     case MID_MESSAGE:
-        m_message.mid.Print(os);
+        std::get<Mid>(m_message).Print(os);
         break;
     case HELLO_MESSAGE:
-        m_message.hello.Print(os);
+        std::get<Hello>(m_message).Print(os);
         break;
     case TC_MESSAGE:
-        m_message.tc.Print(os);
+        std::get<Tc>(m_message).Print(os);
         break;
     case HNA_MESSAGE:
-        m_message.hna.Print(os);
+        std::get<Hna>(m_message).Print(os);
         break;
     default:
         NS_ASSERT(false);
@@ -273,16 +393,16 @@ MessageHeader::Serialize(Buffer::Iterator start) const
     switch (m_messageType)
     {
     case MID_MESSAGE:
-        m_message.mid.Serialize(i);
+        std::get<Mid>(m_message).Serialize(i);
         break;
     case HELLO_MESSAGE:
-        m_message.hello.Serialize(i);
+        std::get<Hello>(m_message).Serialize(i);
         break;
     case TC_MESSAGE:
-        m_message.tc.Serialize(i);
+        std::get<Tc>(m_message).Serialize(i);
         break;
     case HNA_MESSAGE:
-        m_message.hna.Serialize(i);
+        std::get<Hna>(m_message).Serialize(i);
         break;
     default:
         NS_ASSERT(false);
@@ -302,20 +422,22 @@ MessageHeader::Deserialize(Buffer::Iterator start)
     m_timeToLive = i.ReadU8();
     m_hopCount = i.ReadU8();
     m_messageSequenceNumber = i.ReadNtohU16();
+    EnsureMessage();
     size = OLSR_MSG_HEADER_SIZE;
+    uint32_t payloadSize = m_messageSize - OLSR_MSG_HEADER_SIZE;
     switch (m_messageType)
     {
     case MID_MESSAGE:
-        size += m_message.mid.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE);
+        size += std::get<Mid>(m_message).Deserialize(i, payloadSize);
         break;
     case HELLO_MESSAGE:
-        size += m_message.hello.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE);
+        size += std::get<Hello>(m_message).Deserialize(i, payloadSize);
         break;
     case TC_MESSAGE:
-        size += m_message.tc.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE);
+        size += std::get<Tc>(m_message).Deserialize(i, payloadSize);
         break;
     case HNA_MESSAGE:
-        size += m_message.hna.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE);
+        size += std::get<Hna>(m_message).Deserialize(i, payloadSize);
         break;
     default:
         NS_ASSERT(false);
@@ -323,6 +445,61 @@ MessageHeader::Deserialize(Buffer::Iterator start)
     return size;
 }
 
+// ---------------- OLSR Message View -------------------------------
+
+MessageView::MessageView()
+    : m_offset(0),
+      m_size(0),
+      m_header()
+{
+}
+
+uint32_t
+MessageView::Parse(Ptr<const Packet> packet, uint32_t offset, const uint8_t* header, uint32_t size)
+{
+    if (size < HEADER_SIZE || header[0] < MessageHeader::HELLO_MESSAGE ||
+        header[0] > MessageHeader::HNA_MESSAGE)
+    {
+        return 0;
+    }
+    uint16_t messageSize = uint16_t(header[2]) << 8 | header[3];
+    if (messageSize < HEADER_SIZE || messageSize > size)
+    {
+        return 0;
+    }
+    m_packet = packet;
+    m_offset = offset;
+    m_size = messageSize;
+    std::copy(header, header + HEADER_SIZE, m_header);
+    return m_size;
+}
+
+void
+MessageView::PrepareForward()
+{
+    NS_ASSERT(m_header[8] > 0);
+    m_header[8]--;
+    m_header[9]++;
+}
+
+Ptr<Packet>
+MessageView::CreateForwardedMessage() const
+{
+    Ptr<Packet> message = Create<Packet>(m_header, HEADER_SIZE);
+    message->AddAtEnd(m_packet->CreateFragment(m_offset + HEADER_SIZE,
+                                               m_size - HEADER_SIZE));
+    return message;
+}
+
+void
+MessageView::Materialize(MessageHeader& message) const
+{
+    m_packet->CreateFragment(m_offset, m_size)->RemoveHeader(message);
+    // The fields changed for forwarding, if any
+    message.SetTimeToLive(GetTimeToLive());
+    message.SetHopCount(GetHopCount());
+}
+
 // ---------------- OLSR MID Message -------------------------------
 
 uint32_t
@@ -381,12 +558,82 @@ MessageHeader::Mid::Deserialize(Buffer::Iterator start, uint32_t messageSize)
     return GetSerializedSize();
 }
 
+// ---------------- OLSR Position Info -------------------------------
+
+uint32_t
+MessageHeader::PositionInfo::GetSerializedSize() const
+{
+    uint32_t size = 0;
+    if (HasPosition())
+    {
+        size += OLSR_POSITION_WORDS_SIZE;
+    }
+    if (HasVelocity())
+    {
+        size += OLSR_VELOCITY_WORDS_SIZE;
+    }
+    return size;
+}
+
+void
+MessageHeader::PositionInfo::Print(std::ostream& os) const
+{
+    if (HasPosition())
+    {
+        os << " Position: (" << position[0] << ", " << position[1] << ", " << position[2] << ")";
+        os << " Time: " << time << " ms";
+    }
+    if (HasVelocity())
+    {
+        os << " Velocity: (" << velocity[0] << ", " << velocity[1] << ", " << velocity[2]
+           << ") cm/s";
+    }
+}
+
+void
+MessageHeader::PositionInfo::Serialize(Buffer::Iterator& i) const
+{
+    if (HasPosition())
+    {
+        i.WriteHtonU16(position[0]);
+        i.WriteHtonU16(position[1]);
+        i.WriteHtonU16(position[2]);
+        i.WriteHtonU16(time);
+    }
+    if (HasVelocity())
+    {
+        i.WriteHtonU16(static_cast<uint16_t>(velocity[0]));
+        i.WriteHtonU16(static_cast<uint16_t>(velocity[1]));
+        i.WriteHtonU16(static_cast<uint16_t>(velocity[2]));
+        i.WriteHtonU16(0); // Reserved
+    }
+}
+
+void
+MessageHeader::PositionInfo::Deserialize(Buffer::Iterator& i)
+{
+    if (HasPosition())
+    {
+        position[0] = i.ReadNtohU16();
+        position[1] = i.ReadNtohU16();
+        position[2] = i.ReadNtohU16();
+        time = i.ReadNtohU16();
+    }
+    if (HasVelocity())
+    {
+        velocity[0] = static_cast<int16_t>(i.ReadNtohU16());
+        velocity[1] = static_cast<int16_t>(i.ReadNtohU16());
+        velocity[2] = static_cast<int16_t>(i.ReadNtohU16());
+        i.ReadNtohU16(); // Reserved
+    }
+}
+
 // ---------------- OLSR HELLO Message -------------------------------
 
 uint32_t
 MessageHeader::Hello::GetSerializedSize() const
 {
-    uint32_t size = 4;
+    uint32_t size = 4 + positionInfo.GetSerializedSize();
     for (auto iter = this->linkMessages.begin(); iter != this->linkMessages.end(); iter++)
     {
         const LinkMessage& lm = *iter;
@@ -401,6 +648,7 @@ MessageHeader::Hello::Print(std::ostream& os) const
 {
     os << " Interval: " << +hTime << " (" << EmfToSeconds(hTime) << "s)";
     os << " Willingness: " << willingness;
+    positionInfo.Print(os);
 
     for (const auto& ilinkMessage : linkMessages)
     {
@@ -429,9 +677,11 @@ MessageHeader::Hello::Serialize(Buffer::Iterator start) const
 {
     Buffer::Iterator i = start;
 
-    i.WriteU16(0); // Reserved
+    i.WriteU8(0); // Reserved
+    i.WriteU8(positionInfo.flags);
     i.WriteU8(this->hTime);
     i.WriteU8(static_cast<uint8_t>(this->willingness));
+    positionInfo.Serialize(i);
 
     for (auto iter = this->linkMessages.begin(); iter != this->linkMessages.end(); iter++)
     {
@@ -453,13 +703,9 @@ MessageHeader::Hello::Serialize(Buffer::Iterator start) const
             i.WriteHtonU32(neigh_iter->Get());
         }
     }
-
-    i.WriteHtonU64(DoubleToUint64(position.x));
-    i.WriteHtonU64(DoubleToUint64(position.y));
-    i.WriteHtonU64(DoubleToUint64(position.z));
 }
 
-uint32_t 
+uint32_t
 MessageHeader::Hello::Deserialize(Buffer::Iterator start, uint32_t messageSize)
 {
     Buffer::Iterator i = start;
@@ -468,11 +714,19 @@ MessageHeader::Hello::Deserialize(Buffer::Iterator start, uint32_t messageSize)
 
     linkMessages.clear();
 
-    i.ReadNtohU16(); // Reserved
+    i.ReadU8(); // Reserved
+    positionInfo.flags = i.ReadU8();
     hTime = i.ReadU8();
     willingness = static_cast<Willingness>(i.ReadU8());
 
-    uint32_t remainingSize = messageSize - 4;
+    // The flags tell the size of the position words, check it before reading them
+    if (messageSize < 4 + positionInfo.GetSerializedSize())
+    {
+        NS_LOG_WARN("HELLO message parsing error: Deserialize, wrong size. Size: " << messageSize);
+        return 0;
+    }
+    positionInfo.Deserialize(i);
+    uint32_t remainingSize = messageSize - 4 - positionInfo.GetSerializedSize();
 
     while (remainingSize > 0)
     {
@@ -488,11 +742,6 @@ MessageHeader::Hello::Deserialize(Buffer::Iterator start, uint32_t messageSize)
         remainingSize -= lmSize;
     }
 
-    // Position 추가 역직렬화
-    position.x = Uint64ToDouble(i.ReadNtohU64());
-    position.y = Uint64ToDouble(i.ReadNtohU64());
-    position.z = Uint64ToDouble(i.ReadNtohU64());
-
     return messageSize;
 }
 
@@ -501,7 +750,12 @@ MessageHeader::Hello::Deserialize(Buffer::Iterator start, uint32_t messageSize)
 uint32_t
 MessageHeader::Tc::GetSerializedSize() const
 {
-    uint32_t size = 4 + this->neighborAddresses.size() * IPV4_ADDRESS_SIZE + 4 * sizeof(uint64_t);
+    uint32_t size = 4 + positionInfo.GetSerializedSize() +
+                    this->neighborAddresses.size() * IPV4_ADDRESS_SIZE;
+    if (delta)
+    {
+        size += 4 + this->removedAddresses.size() * IPV4_ADDRESS_SIZE;
+    }
     return size;
 }
 
@@ -509,6 +763,10 @@ void
 MessageHeader::Tc::Print(std::ostream& os) const
 {
     os << " Adv. SeqNo: " << ansn;
+    if (delta)
+    {
+        os << " Base Adv. SeqNo: " << baseAnsn << " Added:";
+    }
     os << " [";
     bool first = true;
     for (const auto& iAddr : neighborAddresses)
@@ -523,8 +781,27 @@ MessageHeader::Tc::Print(std::ostream& os) const
         }
         os << iAddr;
     }
-    os << " position: (" << position.x << ", " << position.y << ", " << position.z << ")" << " helloInterval: " << helloInterval;
-
+    os << "]";
+    if (delta)
+    {
+        os << " Removed: [";
+        first = true;
+        for (const auto& iAddr : removedAddresses)
+        {
+            if (first)
+            {
+                first = false;
+            }
+            else
+            {
+                os << ", ";
+            }
+            os << iAddr;
+        }
+        os << "]";
+    }
+    positionInfo.Print(os);
+    os << " Hello interval: " << +helloInterval << " (" << EmfToSeconds(helloInterval) << "s)";
 }
 
 void
@@ -533,25 +810,23 @@ MessageHeader::Tc::Serialize(Buffer::Iterator start) const
     Buffer::Iterator i = start;
 
     i.WriteHtonU16(this->ansn);
-    i.WriteHtonU16(0); // Reserved
+    i.WriteU8(this->helloInterval);
+    i.WriteU8(positionInfo.flags | (delta ? DELTA : 0));
+    positionInfo.Serialize(i);
 
+    if (delta)
+    {
+        i.WriteHtonU16(this->baseAnsn);
+        i.WriteHtonU16(this->neighborAddresses.size());
+    }
     for (auto iter = this->neighborAddresses.begin(); iter != this->neighborAddresses.end(); iter++)
     {
         i.WriteHtonU32(iter->Get());
     }
-
-    i.WriteU64(DoubleToUint64(position.x));
-    i.WriteU64(DoubleToUint64(position.y));
-    i.WriteU64(DoubleToUint64(position.z));
-    i.WriteU64(DoubleToUint64(helloInterval));
-
-    NS_LOG_DEBUG("Serializing TC: position=(" << position.x << "," << position.y << "," << position.z 
-             << "), helloInterval=" << helloInterval
-             << ", bytes: " << std::hex 
-             << DoubleToUint64(position.x) << " "
-             << DoubleToUint64(position.y) << " "
-             << DoubleToUint64(position.z) << " "
-             << DoubleToUint64(helloInterval));
+    for (auto iter = this->removedAddresses.begin(); iter != this->removedAddresses.end(); iter++)
+    {
+        i.WriteHtonU32(iter->Get());
+    }
 }
 
 uint32_t
@@ -560,31 +835,54 @@ MessageHeader::Tc::Deserialize(Buffer::Iterator start, uint32_t messageSize)
     Buffer::Iterator i = start;
 
     this->neighborAddresses.clear();
+    this->removedAddresses.clear();
     NS_ASSERT(messageSize >= 4);
 
     this->ansn = i.ReadNtohU16();
-    i.ReadNtohU16(); // Reserved
-
-    uint32_t size = messageSize - GetSerializedSize ();
-    if (size % sizeof(uint32_t) != 0)
+    this->helloInterval = i.ReadU8();
+    uint8_t flags = i.ReadU8();
+    delta = flags & DELTA;
+    positionInfo.flags = flags & ~DELTA;
+
+    // The flags tell the size of the position words, check it before reading them
+    uint32_t fixedSize = 4 + positionInfo.GetSerializedSize() + (delta ? 4 : 0);
+    if (messageSize < fixedSize)
     {
-      NS_LOG_WARN ("TC message parsing error: Deserialize, wrong size. Size: " << messageSize);
-      return 0;
+        NS_LOG_WARN("TC message parsing error: Deserialize, wrong size. Size: " << messageSize);
+        return 0;
     }
-    int numberOfAddresses = size / sizeof(uint32_t);
-    this->neighborAddresses.clear ();
-    for (int n = 0; n < numberOfAddresses; ++n)
+    positionInfo.Deserialize(i);
+    uint32_t size = messageSize - fixedSize;
+    if (size % IPV4_ADDRESS_SIZE != 0)
     {
-      this->neighborAddresses.push_back (Ipv4Address (i.ReadNtohU32 ()));
+        NS_LOG_WARN("TC message parsing error: Deserialize, wrong size. Size: " << messageSize);
+        return 0;
+    }
+    uint32_t numberOfAddresses = size / IPV4_ADDRESS_SIZE;
+    uint32_t numberOfAdded = numberOfAddresses;
+    if (delta)
+    {
+        this->baseAnsn = i.ReadNtohU16();
+        numberOfAdded = i.ReadNtohU16();
+        if (numberOfAdded > numberOfAddresses)
+        {
+            NS_LOG_WARN("TC message parsing error: Deserialize, wrong number of added "
+                        "neighbors: "
+                        << numberOfAdded);
+            return 0;
+        }
+    }
+    for (uint32_t n = 0; n < numberOfAddresses; ++n)
+    {
+        if (n < numberOfAdded)
+        {
+            this->neighborAddresses.emplace_back(i.ReadNtohU32());
+        }
+        else
+        {
+            this->removedAddresses.emplace_back(i.ReadNtohU32());
+        }
     }
-
-    position.x = Uint64ToDouble(i.ReadU64());
-    position.y = Uint64ToDouble(i.ReadU64());
-    position.z = Uint64ToDouble(i.ReadU64());
-    helloInterval = Uint64ToDouble(i.ReadU64());
-
-    NS_LOG_DEBUG("Deserialized TC: position=(" << position.x << "," << position.y << "," << position.z 
-             << "), helloInterval=" << helloInterval);
 
     return messageSize;
 }
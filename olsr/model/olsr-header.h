@@ -25,12 +25,12 @@
 #include "ns3/header.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
+#include "ns3/packet.h"
 #include "ns3/vector.h"
 
 #include <stdint.h>
+#include <variant>
 #include <vector>
-#include <cstring>
-#include <arpa/inet.h>
 
 namespace ns3
 {
@@ -39,20 +39,10 @@ namespace olsr
 
 double EmfToSeconds(uint8_t emf);
 uint8_t SecondsToEmf(double seconds);
-
-inline uint64_t DoubleToUint64(double value)
-{
-    uint64_t result;
-    std::memcpy(&result, &value, sizeof(double));
-    return result;
-}
-
-inline double Uint64ToDouble(uint64_t value)
-{
-    double result;
-    std::memcpy(&result, &value, sizeof(double));
-    return result;
-}
+uint16_t CoordinateToFixed(double coordinate, double origin, double resolution);
+double FixedToCoordinate(uint16_t fixed, double origin, double resolution);
+int16_t VelocityToFixed(double velocity);
+double FixedToVelocity(int16_t fixed);
 
 /**
  * \ingroup olsr
@@ -192,13 +182,10 @@ class MessageHeader : public Header
     ~MessageHeader() override;
 
     /**
-     * Set the message type.
+     * Set the message type. The message content is reset if the type changes.
      * \param messageType The message type.
      */
-    void SetMessageType(MessageType messageType)
-    {
-        m_messageType = messageType;
-    }
+    void SetMessageType(MessageType messageType);
 
     /**
      * Get the message type.
@@ -369,6 +356,165 @@ class MessageHeader : public Header
         uint32_t Deserialize(Buffer::Iterator start, uint32_t messageSize);
     };
 
+    /**
+     * \ingroup olsr
+     * Position Info carried in HELLO and TC messages (not part of the RFC).
+     *
+    \verbatim
+      0                   1                   2                   3
+      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+
+     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+     |          Position X           |          Position Y           |
+     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+     |          Position Z           |         Position Time         |
+     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+     |          Velocity X           |          Velocity Y           |
+     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+     |          Velocity Z           |           Reserved            |
+     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    \endverbatim
+    *
+    * The position words are present if the POSITION_PRESENT flag is set, and
+    * the velocity words if the VELOCITY_PRESENT flag is set. The flags are
+    * carried in the fixed part of the message.
+    *
+    * Coordinates are unsigned fixed point values, counted in units of the
+    * position resolution from the area origin. Velocities are signed values
+    * in cm/s. A message without a position tells the receivers that the
+    * position they extrapolate from the previous one is still accurate.
+    *
+    * The Position Time is the time the position was sampled at, in milliseconds
+    * modulo 2^16, on the clock shared by the nodes (e.g., GPS time). Receivers
+    * extrapolate the position from that time, whatever the queuing and forwarding
+    * delays of the message.
+    */
+    struct PositionInfo
+    {
+        /// Position Info flags.
+        enum Flags : uint8_t
+        {
+            POSITION_PRESENT = 0x1, //!< The position words are present.
+            VELOCITY_PRESENT = 0x2, //!< The velocity words are present.
+        };
+
+        uint8_t flags = 0;    //!< Position Info flags.
+        uint16_t position[3]; //!< Node coordinates (fixed point coded).
+        uint16_t time;        //!< Position sampling time (ms, modulo 2^16).
+        int16_t velocity[3];  //!< Node velocity (coded in cm/s).
+
+        /**
+         * Set the node position.
+         * \param pos The node position.
+         * \param origin The origin of the simulation area.
+         * \param resolution The coordinate resolution, in meters.
+         */
+        void SetPosition(const Vector& pos, const Vector& origin, double resolution)
+        {
+            flags |= POSITION_PRESENT;
+            position[0] = CoordinateToFixed(pos.x, origin.x, resolution);
+            position[1] = CoordinateToFixed(pos.y, origin.y, resolution);
+            position[2] = CoordinateToFixed(pos.z, origin.z, resolution);
+        }
+
+        /**
+         * Get the node position.
+         * \param origin The origin of the simulation area.
+         * \param resolution The coordinate resolution, in meters.
+         * \return The node position.
+         */
+        Vector GetPosition(const Vector& origin, double resolution) const
+        {
+            return Vector(FixedToCoordinate(position[0], origin.x, resolution),
+                          FixedToCoordinate(position[1], origin.y, resolution),
+                          FixedToCoordinate(position[2], origin.z, resolution));
+        }
+
+        /**
+         * Set the time the position was sampled at.
+         * \param now The sampling time.
+         */
+        void SetTime(Time now)
+        {
+            time = static_cast<uint16_t>(now.GetMilliSeconds());
+        }
+
+        /**
+         * Get the time the position was sampled at.
+         * \param now The current time.
+         * \return The sampling time, less than 65.536 seconds before now.
+         */
+        Time GetTime(Time now) const
+        {
+            uint16_t age = static_cast<uint16_t>(now.GetMilliSeconds()) - time;
+            return now - MilliSeconds(age);
+        }
+
+        /**
+         * Set the node velocity.
+         * \param vel The node velocity.
+         */
+        void SetVelocity(const Vector& vel)
+        {
+            flags |= VELOCITY_PRESENT;
+            velocity[0] = VelocityToFixed(vel.x);
+            velocity[1] = VelocityToFixed(vel.y);
+            velocity[2] = VelocityToFixed(vel.z);
+        }
+
+        /**
+         * Get the node velocity.
+         * \return The node velocity, or zero if it is not present.
+         */
+        Vector GetVelocity() const
+        {
+            if (!HasVelocity())
+            {
+                return Vector(0, 0, 0);
+            }
+            return Vector(FixedToVelocity(velocity[0]),
+                          FixedToVelocity(velocity[1]),
+                          FixedToVelocity(velocity[2]));
+        }
+
+        /**
+         * \return true if the position words are present.
+         */
+        bool HasPosition() const
+        {
+            return flags & POSITION_PRESENT;
+        }
+
+        /**
+         * \return true if the velocity words are present.
+         */
+        bool HasVelocity() const
+        {
+            return flags & VELOCITY_PRESENT;
+        }
+
+        /**
+         * This method is used to print the content of the Position Info.
+         * \param os output stream
+         */
+        void Print(std::ostream& os) const;
+        /**
+         * Returns the expected size of the Position Info.
+         * \returns the expected size of the Position Info.
+         */
+        uint32_t GetSerializedSize() const;
+        /**
+         * Writes the position and velocity words present in the flags.
+         * \param i an iterator which points to where the words should be written.
+         */
+        void Serialize(Buffer::Iterator& i) const;
+        /**
+         * Reads the position and velocity words present in the flags.
+         * \param i an iterator which points to where the words should be read from.
+         */
+        void Deserialize(Buffer::Iterator& i);
+    };
+
     /**
      * \ingroup olsr
      * HELLO Message Format
@@ -378,7 +524,9 @@ class MessageHeader : public Header
       0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
 
      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-     |          Reserved             |     Htime     |  Willingness  |
+     |   Reserved    |  Pos. Flags   |     Htime     |  Willingness  |
+     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+     :                  Position Info (0, 8 or 16 bytes)             :
      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
      |   Link Code   |   Reserved    |       Link Message Size       |
      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -398,11 +546,13 @@ class MessageHeader : public Header
      :                                                               :
        (etc.)
     \endverbatim
+    *
+    * The Position Info layout is described in PositionInfo.
     */
     struct Hello
     {
         uint8_t linkValidityTime;
-        Vector position; //!< 노드 좌표 (추가된 필드)
+        PositionInfo positionInfo; //!< 노드 좌표 (추가된 필드)
 
         void SetLinkValidityTime(Time time)
         {
@@ -458,16 +608,6 @@ class MessageHeader : public Header
          * \returns the expected size of the header.
          */
 
-        void SetPosition(const Vector& pos)
-        {
-            position = pos;
-        }
-
-        Vector GetPosition() const
-        {
-            return position;
-        }
-
         uint32_t GetSerializedSize() const;
         /**
          * This method is used by Packet::AddHeader to
@@ -497,45 +637,71 @@ class MessageHeader : public Header
        0                   1                   2                   3
        0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-      |              ANSN             |           Reserved            |
+      |              ANSN             |     Htime     |  Pos. Flags   |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      :                  Position Info (0, 8 or 16 bytes)             :
       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
       |               Advertised Neighbor Main Address                |
       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
       |               Advertised Neighbor Main Address                |
       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-      |                          Hello Timer                          |
+      |                              ...                              |
       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-      |                         Node Position                         |
+     \endverbatim
+     *
+     * Htime is the originator's HELLO emission interval, coded like the
+     * HELLO Htime field. The Position Info layout is described in PositionInfo.
+     *
+     * A differential TC message, flagged by the DELTA bit of the flags byte,
+     * only carries the changes to the advertised neighbors since the message
+     * with the base ANSN:
+     *
+     \verbatim
       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-      |                              ...                              |
+      |              ANSN             |     Htime     |D| Pos. Flags  |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      :                  Position Info (0, 8 or 16 bytes)             :
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      |           Base ANSN           |        Number Of Added        |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      :              Added Neighbor Main Addresses                    :
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      :              Removed Neighbor Main Addresses                  :
       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
      \endverbatim
      */
     struct Tc
     {
-        std::vector<Ipv4Address> neighborAddresses; //!< Neighbor address container.
-        uint16_t ansn;                              //!< Advertised Neighbor Sequence Number.
-        Vector position;
-        double helloInterval;
-
-        void SetPosition(const Vector& pos) 
+        /// TC flags, sharing the byte of the Position Info flags.
+        enum Flags : uint8_t
         {
-            position = pos;
-        }
+            DELTA = 0x80, //!< Only the changes since the base ANSN are carried.
+        };
 
-        Vector GetPosition() const
-        {
-            return position;
-        }
+        std::vector<Ipv4Address> neighborAddresses; //!< Neighbor (or added neighbor) addresses.
+        std::vector<Ipv4Address> removedAddresses;  //!< Removed neighbor addresses (delta only).
+        uint16_t ansn;                              //!< Advertised Neighbor Sequence Number.
+        uint16_t baseAnsn = 0;                      //!< ANSN the changes apply to (delta only).
+        bool delta = false;                         //!< Whether only the changes are carried.
+        PositionInfo positionInfo;                  //!< Node position and velocity.
+        uint8_t helloInterval;                      //!< HELLO emission interval (coded).
 
-        void SetHelloInterval(double interval) 
+        /**
+         * Set the originator's HELLO emission interval.
+         * \param interval The HELLO emission interval.
+         */
+        void SetHelloInterval(Time interval)
         {
-            helloInterval = interval;
+            helloInterval = SecondsToEmf(interval.GetSeconds());
         }
 
-        double GetHelloInterval() const
+        /**
+         * Get the originator's HELLO emission interval.
+         * \return The HELLO emission interval.
+         */
+        Time GetHelloInterval() const
         {
-            return helloInterval;
+            return Seconds(EmfToSeconds(helloInterval));
         }
 
         /**
@@ -633,15 +799,14 @@ class MessageHeader : public Header
 
   private:
     /**
-     * Structure holding the message content.
+     * Makes the message content hold the payload of the message type, unless it already does.
      */
-    struct
-    {
-        Mid mid;     //!< MID message (optional).
-        Hello hello; //!< HELLO message (optional).
-        Tc tc;       //!< TC message (optional).
-        Hna hna;     //!< HNA message (optional).
-    } m_message;     //!< The actual message being carried.
+    void EnsureMessage();
+
+    /**
+     * The actual message being carried, holding only the payload of the message type.
+     */
+    std::variant<std::monostate, Mid, Hello, Tc, Hna> m_message;
 
   public:
     /**
@@ -652,13 +817,13 @@ class MessageHeader : public Header
     {
         if (m_messageType == 0)
         {
-            m_messageType = MID_MESSAGE;
+            SetMessageType(MID_MESSAGE);
         }
         else
         {
             NS_ASSERT(m_messageType == MID_MESSAGE);
         }
-        return m_message.mid;
+        return std::get<Mid>(m_message);
     }
 
     /**
@@ -669,13 +834,13 @@ class MessageHeader : public Header
     {
         if (m_messageType == 0)
         {
-            m_messageType = HELLO_MESSAGE;
+            SetMessageType(HELLO_MESSAGE);
         }
         else
         {
             NS_ASSERT(m_messageType == HELLO_MESSAGE);
         }
-        return m_message.hello;
+        return std::get<Hello>(m_message);
     }
 
     /**
@@ -686,13 +851,13 @@ class MessageHeader : public Header
     {
         if (m_messageType == 0)
         {
-            m_messageType = TC_MESSAGE;
+            SetMessageType(TC_MESSAGE);
         }
         else
         {
             NS_ASSERT(m_messageType == TC_MESSAGE);
         }
-        return m_message.tc;
+        return std::get<Tc>(m_message);
     }
 
     /**
@@ -703,13 +868,13 @@ class MessageHeader : public Header
     {
         if (m_messageType == 0)
         {
-            m_messageType = HNA_MESSAGE;
+            SetMessageType(HNA_MESSAGE);
         }
         else
         {
             NS_ASSERT(m_messageType == HNA_MESSAGE);
         }
-        return m_message.hna;
+        return std::get<Hna>(m_message);
     }
 
     /**
@@ -719,7 +884,7 @@ class MessageHeader : public Header
     const Mid& GetMid() const
     {
         NS_ASSERT(m_messageType == MID_MESSAGE);
-        return m_message.mid;
+        return std::get<Mid>(m_message);
     }
 
     /**
@@ -729,7 +894,7 @@ class MessageHeader : public Header
     const Hello& GetHello() const
     {
         NS_ASSERT(m_messageType == HELLO_MESSAGE);
-        return m_message.hello;
+        return std::get<Hello>(m_message);
     }
 
     /**
@@ -739,7 +904,7 @@ class MessageHeader : public Header
     const Tc& GetTc() const
     {
         NS_ASSERT(m_messageType == TC_MESSAGE);
-        return m_message.tc;
+        return std::get<Tc>(m_message);
     }
 
     /**
@@ -749,7 +914,7 @@ class MessageHeader : public Header
     const Hna& GetHna() const
     {
         NS_ASSERT(m_messageType == HNA_MESSAGE);
-        return m_message.hna;
+        return std::get<Hna>(m_message);
     }
 };
 
@@ -785,6 +950,113 @@ operator<<(std::ostream& os, const MessageList& messages)
     return os;
 }
 
+/**
+ * \ingroup olsr
+ *
+ * A view over an %OLSR message in a received packet.
+ *
+ * Only the fixed message header fields are decoded, into a copy held by the view, so that
+ * duplicated messages can be recognized and forwarded without decoding their payload. The
+ * payload stays in the packet, and is shared copy-on-write by the decoded and forwarded
+ * messages.
+ */
+class MessageView
+{
+  public:
+    /// Size of the fixed message header fields.
+    static constexpr uint32_t HEADER_SIZE = 12;
+
+    MessageView();
+
+    /**
+     * \brief Decodes the fixed header fields of a message.
+     * \param packet The packet holding the message.
+     * \param offset The offset of the message in the packet.
+     * \param header The fixed header bytes of the message, copied from the packet.
+     * \param size The number of bytes available from the offset.
+     * \returns The message size, or 0 if the bytes do not hold a valid message.
+     */
+    uint32_t Parse(Ptr<const Packet> packet, uint32_t offset, const uint8_t* header, uint32_t size);
+
+    /**
+     * Get the message type.
+     * \return The message type.
+     */
+    MessageHeader::MessageType GetMessageType() const
+    {
+        return MessageHeader::MessageType(m_header[0]);
+    }
+
+    /**
+     * Get the originator address.
+     * \return The originator address.
+     */
+    Ipv4Address GetOriginatorAddress() const
+    {
+        return Ipv4Address(uint32_t(m_header[4]) << 24 | uint32_t(m_header[5]) << 16 |
+                           uint32_t(m_header[6]) << 8 | m_header[7]);
+    }
+
+    /**
+     * Get the time to live.
+     * \return The time to live.
+     */
+    uint8_t GetTimeToLive() const
+    {
+        return m_header[8];
+    }
+
+    /**
+     * Get the hop count.
+     * \return The hop count.
+     */
+    uint8_t GetHopCount() const
+    {
+        return m_header[9];
+    }
+
+    /**
+     * Get the message sequence number.
+     * \return The message sequence number.
+     */
+    uint16_t GetMessageSequenceNumber() const
+    {
+        return uint16_t(m_header[10]) << 8 | m_header[11];
+    }
+
+    /**
+     * Get the message size.
+     * \return The message size.
+     */
+    uint32_t GetSize() const
+    {
+        return m_size;
+    }
+
+    /**
+     * \brief Decreases the time to live and increases the hop count.
+     */
+    void PrepareForward();
+
+    /**
+     * \brief Builds the message to forward, with the current fixed header fields.
+     * \returns The serialized message.
+     */
+    Ptr<Packet> CreateForwardedMessage() const;
+
+    /**
+     * \brief Decodes the whole message.
+     * \param message The message to decode into.
+     */
+    void Materialize(MessageHeader& message) const;
+
+  private:
+    Ptr<const Packet> m_packet;    //!< The packet holding the message.
+    uint32_t m_offset;             //!< The offset of the message in the packet.
+    uint16_t m_size;               //!< The message size.
+    uint8_t m_header[HEADER_SIZE]; //!< The fixed header bytes.
+};
+
 } // namespace olsr
 } // namespace ns3
 
@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+///
+/// \file olsr-hna-routing-table.cc
+/// \brief Implementation of the longest prefix match table of the HNA routes.
+///
+
+#include "olsr-hna-routing-table.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace ns3
+{
+namespace olsr
+{
+
+namespace
+{
+
+/**
+ * Gets a bit of an address, counting from the most significant one.
+ * \param address The address.
+ * \param depth The position of the bit.
+ * \returns The bit.
+ */
+inline uint32_t
+GetBit(uint32_t address, uint16_t depth)
+{
+    return (address >> (31 - depth)) & 1;
+}
+
+} // unnamed namespace
+
+HnaRoutingTable::HnaRoutingTable()
+    : m_nodes(1)
+{
+}
+
+uint32_t
+HnaRoutingTable::FindNode(uint32_t networkAddr, uint16_t prefixLength, bool create)
+{
+    uint32_t node = 0;
+    for (uint16_t depth = 0; depth < prefixLength; depth++)
+    {
+        uint32_t bit = GetBit(networkAddr, depth);
+        if (m_nodes[node].child[bit] == NONE)
+        {
+            if (!create)
+            {
+                return NONE;
+            }
+            m_nodes[node].child[bit] = m_nodes.size();
+            m_nodes.emplace_back();
+        }
+        node = m_nodes[node].child[bit];
+    }
+    return node;
+}
+
+uint32_t
+HnaRoutingTable::FindNode(uint32_t networkAddr, uint16_t prefixLength) const
+{
+    uint32_t node = 0;
+    for (uint16_t depth = 0; depth < prefixLength && node != NONE; depth++)
+    {
+        node = m_nodes[node].child[GetBit(networkAddr, depth)];
+    }
+    return node;
+}
+
+bool
+HnaRoutingTable::AddRoute(const HnaRoute& route)
+{
+    uint32_t node = FindNode(route.networkAddr.CombineMask(route.netmask).Get(),
+                             route.netmask.GetPrefixLength(),
+                             true);
+    uint32_t& index = m_nodes[node].route;
+    if (index == NONE)
+    {
+        index = m_routes.size();
+        m_routes.push_back(route);
+        return true;
+    }
+    if (m_routes[index].distance > route.distance)
+    {
+        m_routes[index] = route;
+        return true;
+    }
+    return false;
+}
+
+const HnaRoute*
+HnaRoutingTable::FindRoute(const Ipv4Address& networkAddr, const Ipv4Mask& netmask) const
+{
+    uint32_t node = FindNode(networkAddr.CombineMask(netmask).Get(), netmask.GetPrefixLength());
+    if (node == NONE || m_nodes[node].route == NONE)
+    {
+        return nullptr;
+    }
+    return &m_routes[m_nodes[node].route];
+}
+
+const HnaRoute*
+HnaRoutingTable::Lookup(const Ipv4Address& dest) const
+{
+    const uint32_t address = dest.Get();
+    uint32_t best = m_nodes[0].route;
+    uint32_t node = 0;
+    for (uint16_t depth = 0; depth < 32; depth++)
+    {
+        node = m_nodes[node].child[GetBit(address, depth)];
+        if (node == NONE)
+        {
+            break;
+        }
+        if (m_nodes[node].route != NONE)
+        {
+            best = m_nodes[node].route;
+        }
+    }
+    return (best == NONE) ? nullptr : &m_routes[best];
+}
+
+void
+HnaRoutingTable::Clear()
+{
+    m_nodes.resize(1);
+    m_nodes[0] = Node();
+    m_routes.clear();
+}
+
+void
+HnaRoutingTable::Swap(HnaRoutingTable& other)
+{
+    m_nodes.swap(other.m_nodes);
+    m_routes.swap(other.m_routes);
+}
+
+void
+HnaRoutingTable::Print(std::ostream& os) const
+{
+    os << std::setw(16) << "Network";
+    os << std::setw(16) << "Netmask";
+    os << std::setw(16) << "NextHop";
+    os << std::setw(16) << "Interface";
+    os << "Distance" << std::endl;
+
+    for (const HnaRoute& route : m_routes)
+    {
+        std::ostringstream network;
+        std::ostringstream netmask;
+        std::ostringstream nextHop;
+        network << route.networkAddr;
+        netmask << route.netmask;
+        nextHop << route.nextAddr;
+        os << std::setw(16) << network.str();
+        os << std::setw(16) << netmask.str();
+        os << std::setw(16) << nextHop.str();
+        os << std::setw(16) << route.interface;
+        os << route.distance << std::endl;
+    }
+}
+
+} // namespace olsr
+} // namespace ns3
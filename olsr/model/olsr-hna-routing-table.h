@@ -0,0 +1,147 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OLSR_HNA_ROUTING_TABLE_H
+#define OLSR_HNA_ROUTING_TABLE_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ptr.h"
+
+#include <iostream>
+#include <vector>
+
+namespace ns3
+{
+namespace olsr
+{
+
+/// \ingroup olsr
+/// A route to a network announced in HNA messages.
+struct HnaRoute
+{
+    Ipv4Address networkAddr; //!< Address of the network.
+    Ipv4Mask netmask;        //!< Netmask of the network.
+    Ipv4Address nextAddr;    //!< Address of the next hop towards the gateway.
+    uint32_t interface;      //!< Interface index of the next hop.
+    uint32_t distance;       //!< Distance in hops to the gateway.
+    Ptr<Ipv4Route> route;    //!< Route handed out to the data plane, if already built.
+};
+
+/// \ingroup olsr
+/// Routes to the networks announced in HNA messages, with longest prefix matching.
+///
+/// The routes are kept in a binary trie indexed by the bits of the network address, so that a
+/// lookup walks at most as many nodes as the longest prefix length. Netmasks are assumed to be
+/// contiguous. The table is meant to be rebuilt in bulk: Clear() keeps the allocated memory.
+class HnaRoutingTable
+{
+  public:
+    HnaRoutingTable();
+
+    /**
+     * \brief Adds a route, unless the table already has a route to the same network with a
+     * distance lower than or equal to the new one.
+     * \param route The route.
+     * \returns true if the route was added.
+     */
+    bool AddRoute(const HnaRoute& route);
+
+    /**
+     * \brief Finds the route to a network.
+     * \param networkAddr The network address.
+     * \param netmask The network mask.
+     * \returns The route, or nullptr if not found.
+     */
+    const HnaRoute* FindRoute(const Ipv4Address& networkAddr, const Ipv4Mask& netmask) const;
+
+    /**
+     * \brief Looks up the route with the longest prefix matching a destination.
+     * \param dest The destination address.
+     * \returns The route, or nullptr if no network contains the destination.
+     */
+    const HnaRoute* Lookup(const Ipv4Address& dest) const;
+
+    /**
+     * \brief Removes all the routes.
+     */
+    void Clear();
+
+    /**
+     * \brief Exchanges the routes of two tables, without copying them.
+     * \param other The other table.
+     */
+    void Swap(HnaRoutingTable& other);
+
+    /**
+     * Gets the number of routes.
+     * \returns The number of routes.
+     */
+    uint32_t GetNRoutes() const
+    {
+        return m_routes.size();
+    }
+
+    /**
+     * Gets the routes, in no particular order.
+     * \returns The routes.
+     */
+    const std::vector<HnaRoute>& GetRoutes() const
+    {
+        return m_routes;
+    }
+
+    /**
+     * \brief Prints the routes.
+     * \param os The output stream.
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /// Sentinel index of a missing trie node or route.
+    static constexpr uint32_t NONE = 0xffffffff;
+
+    /// A trie node, matching the prefix of the path from the root.
+    struct Node
+    {
+        uint32_t child[2] = {NONE, NONE}; //!< Children for the next bit set to 0 and 1.
+        uint32_t route = NONE;            //!< Route to the prefix, if any.
+    };
+
+    /**
+     * \brief Finds the node of a prefix.
+     * \param networkAddr The network address.
+     * \param prefixLength The prefix length.
+     * \param create Whether the missing nodes must be created.
+     * \returns The node index, or NONE if not found.
+     */
+    uint32_t FindNode(uint32_t networkAddr, uint16_t prefixLength, bool create);
+
+    /**
+     * \brief Finds the node of a prefix.
+     * \param networkAddr The network address.
+     * \param prefixLength The prefix length.
+     * \returns The node index, or NONE if not found.
+     */
+    uint32_t FindNode(uint32_t networkAddr, uint16_t prefixLength) const;
+
+    std::vector<Node> m_nodes;      //!< Trie nodes, the root first.
+    std::vector<HnaRoute> m_routes; //!< Routes, referred to by the trie nodes.
+};
+
+} // namespace olsr
+} // namespace ns3
+
+#endif /* OLSR_HNA_ROUTING_TABLE_H */
@@ -26,8 +26,10 @@
 #include "ns3/nstime.h"
 #include "ns3/vector.h"
 
+#include <bitset>
 #include <iostream>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -97,6 +99,9 @@ struct IfaceAssocTuple
     Ipv4Address mainAddr;
     /// Time at which this tuple expires and must be removed.
     Time time;
+    /// Generation of the tuple, telling its expiry entries apart from the ones left by a
+    /// removed tuple with the same key.
+    uint32_t generation = 0;
 };
 
 inline bool
@@ -127,6 +132,9 @@ struct LinkTuple
     Time asymTime;
     /// Time at which this tuple expires and must be removed.
     Time time;
+    /// Generation of the tuple, telling its expiry entries apart from the ones left by a
+    /// removed tuple with the same key.
+    uint32_t generation = 0;
 };
 
 inline bool
@@ -197,6 +205,9 @@ struct TwoHopNeighborTuple
     Time expirationTime; // previously called 'time_'
     /// Hello interval of this 2-hop neighbor
     Time helloInterval;
+    /// Generation of the tuple, telling its expiry entries apart from the ones left by a
+    /// removed tuple with the same key.
+    uint32_t generation = 0;
 };
 
 inline std::ostream&
@@ -223,6 +234,9 @@ struct MprSelectorTuple
     Ipv4Address mainAddr;
     /// Time at which this tuple expires and must be removed.
     Time expirationTime; // previously called 'time_'
+    /// Generation of the tuple, telling its expiry entries apart from the ones left by a
+    /// removed tuple with the same key.
+    uint32_t generation = 0;
 };
 
 inline bool
@@ -235,27 +249,28 @@ operator==(const MprSelectorTuple& a, const MprSelectorTuple& b)
 // typedef std::vector<nsaddr_t> addr_list_t;
 
 /// \ingroup olsr
-/// A Duplicate Tuple
-struct DuplicateTuple
+/// The Duplicate Tuples of one originator, kept as a window over its most
+/// recent message sequence numbers.
+///
+/// Each message in the window has a slot, indexed by its sequence number
+/// modulo WINDOW_SIZE. Messages older than the window count as duplicates.
+struct DuplicateWindow
 {
-    /// Originator address of the message.
-    Ipv4Address address;
-    /// Message sequence number.
-    uint16_t sequenceNumber;
-    /// Indicates whether the message has been retransmitted or not.
-    bool retransmitted;
-    /// List of interfaces which the message has been received on.
-    std::vector<Ipv4Address> ifaceList;
-    /// Time at which this tuple expires and must be removed.
+    /// Number of sequence numbers in the window. Divides 2^16, so that the
+    /// slots stay consistent when the sequence numbers wrap around.
+    static constexpr uint16_t WINDOW_SIZE = 128;
+
+    /// Most recent message sequence number of the originator.
+    uint16_t lastSequenceNumber;
+    /// Interfaces which each message has been received on, one bit per
+    /// interface index modulo 8. Zero if the message has not been received.
+    uint8_t ifaces[WINDOW_SIZE];
+    /// Indicates whether each message has been retransmitted or not.
+    std::bitset<WINDOW_SIZE> retransmitted;
+    /// Time at which the window expires and must be removed.
     Time expirationTime;
 };
 
-inline bool
-operator==(const DuplicateTuple& a, const DuplicateTuple& b)
-{
-    return (a.address == b.address && a.sequenceNumber == b.sequenceNumber);
-}
-
 /// \ingroup olsr
 /// A Topology Tuple
 struct TopologyTuple
@@ -272,6 +287,9 @@ struct TopologyTuple
     Vector position;
     /// 노드 hello interval
     Time helloInterval;
+    /// Generation of the tuple, telling its expiry entries apart from the ones left by a
+    /// removed tuple with the same key.
+    uint32_t generation = 0;
 };
 
 inline bool
@@ -323,6 +341,9 @@ struct AssociationTuple
     Ipv4Mask netmask;
     /// Time at which this tuple expires and must be removed
     Time expirationTime;
+    /// Generation of the tuple, telling its expiry entries apart from the ones left by a
+    /// removed tuple with the same key.
+    uint32_t generation = 0;
 };
 
 inline bool
@@ -347,7 +368,8 @@ typedef std::vector<LinkTuple> LinkSet;                     //!< Link Set type.
 typedef std::vector<NeighborTuple> NeighborSet;             //!< Neighbor Set type.
 typedef std::vector<TwoHopNeighborTuple> TwoHopNeighborSet; //!< 2-hop Neighbor Set type.
 typedef std::vector<TopologyTuple> TopologySet;             //!< Topology Set type.
-typedef std::vector<DuplicateTuple> DuplicateSet;           //!< Duplicate Set type.
+typedef std::unordered_map<Ipv4Address, DuplicateWindow, Ipv4AddressHash>
+    DuplicateSet; //!< Duplicate Set type, by originator address.
 typedef std::vector<IfaceAssocTuple> IfaceAssocSet;         //!< Interface Association Set type.
 typedef std::vector<AssociationTuple> AssociationSet;       //!< Association Set type.
 typedef std::vector<Association> Associations;              //!< Association Set type.
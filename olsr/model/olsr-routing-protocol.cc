@@ -37,6 +37,7 @@
 #include "olsr-repositories.h"
 
 #include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/enum.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/ipv4-header.h"
@@ -48,15 +49,22 @@
 #include "ns3/names.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
+#include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 #include "ns3/mobility-model.h"
 #include "ns3/vector.h"
 
+#include <algorithm>
 #include <vector>
+#include <bitset>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <unordered_map>
 
 /********** Useful macros **********/
 
@@ -102,12 +110,18 @@
 /// Maximum number of messages per packet.
 #define OLSR_MAX_MSGS 64
 
+/// Size of the IPv4 and UDP headers in front of an OLSR packet.
+#define OLSR_IP_UDP_HEADER_SIZE 28
+
 /// Maximum number of hellos per message (4 possible link types * 3 possible nb types).
 #define OLSR_MAX_HELLOS 12
 
 /// Maximum number of addresses advertised on a message.
 #define OLSR_MAX_ADDRS 64
 
+/// Minimum size of the expiry queue before it is compacted.
+#define OLSR_EXPIRY_COMPACT_MIN_SIZE 256
+
 namespace ns3
 {
 
@@ -240,6 +254,133 @@ RoutingProtocol::GetTypeId()
                                           "high",
                                           Willingness::ALWAYS,
                                           "always"))
+            .AddAttribute("TcRedundancy",
+                          "Neighbors advertised in TC messages.",
+                          EnumValue(RoutingProtocol::MPR_SELECTORS),
+                          MakeEnumAccessor<TcRedundancy>(&RoutingProtocol::m_tcRedundancy),
+                          MakeEnumChecker(RoutingProtocol::MPR_SELECTORS,
+                                          "mpr-selectors",
+                                          RoutingProtocol::MPR_SELECTORS_AND_MPRS,
+                                          "mpr-selectors-and-mprs",
+                                          RoutingProtocol::ALL_NEIGHBORS,
+                                          "all-neighbors"))
+            .AddAttribute("FisheyeTtls",
+                          "Comma-separated TTLs cycled through by successive TC messages, so "
+                          "that distant nodes receive them less often, e.g. \"2,4,255\". "
+                          "Empty sends every TC message with a TTL of 255.",
+                          StringValue(""),
+                          MakeStringAccessor(&RoutingProtocol::m_fisheyeTtlList),
+                          MakeStringChecker())
+            .AddAttribute("DifferentialTc",
+                          "Send TC messages carrying only the changes to the advertised "
+                          "neighbors since the previous TC message, when they are shorter.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_differentialTc),
+                          MakeBooleanChecker())
+            .AddAttribute("TcFullRefreshPeriod",
+                          "With DifferentialTc, one TC message out of this many advertises all "
+                          "the neighbors.",
+                          UintegerValue(3),
+                          MakeUintegerAccessor(&RoutingProtocol::m_tcFullRefreshPeriod),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("PositionOrigin",
+                          "Origin of the area that node positions in HELLO and TC messages are "
+                          "encoded relative to.",
+                          VectorValue(Vector(0, 0, 0)),
+                          MakeVectorAccessor(&RoutingProtocol::m_positionOrigin),
+                          MakeVectorChecker())
+            .AddAttribute("PositionResolution",
+                          "Resolution, in meters, of node positions in HELLO and TC messages. "
+                          "Coordinates cover 65535 steps from the PositionOrigin.",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&RoutingProtocol::m_positionResolution),
+                          MakeDoubleChecker<double>(0.001))
+            .AddAttribute("AdaptiveTimers",
+                          "Adapt the HELLO and TC emission intervals to the node speed. "
+                          "The speed bands replace HelloInterval and TcInterval.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_adaptiveTimers),
+                          MakeBooleanChecker())
+            .AddAttribute("LowSpeedThreshold",
+                          "Speed, in m/s, from which a node uses the medium speed intervals.",
+                          DoubleValue(25.0),
+                          MakeDoubleAccessor(&RoutingProtocol::m_lowSpeedThreshold),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("HighSpeedThreshold",
+                          "Speed, in m/s, from which a node uses the high speed intervals.",
+                          DoubleValue(40.0),
+                          MakeDoubleAccessor(&RoutingProtocol::m_highSpeedThreshold),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("SpeedHysteresis",
+                          "How far, in m/s, below a speed threshold a node must slow down "
+                          "before it goes back to the slower band.",
+                          DoubleValue(2.0),
+                          MakeDoubleAccessor(&RoutingProtocol::m_speedHysteresis),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("LowSpeedHelloInterval",
+                          "HELLO messages emission interval below LowSpeedThreshold.",
+                          TimeValue(Seconds(2.0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_lowSpeedHelloInterval),
+                          MakeTimeChecker())
+            .AddAttribute("MediumSpeedHelloInterval",
+                          "HELLO messages emission interval between the speed thresholds.",
+                          TimeValue(Seconds(1.0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_mediumSpeedHelloInterval),
+                          MakeTimeChecker())
+            .AddAttribute("HighSpeedHelloInterval",
+                          "HELLO messages emission interval above HighSpeedThreshold.",
+                          TimeValue(Seconds(0.5)),
+                          MakeTimeAccessor(&RoutingProtocol::m_highSpeedHelloInterval),
+                          MakeTimeChecker())
+            .AddAttribute("LowSpeedTcInterval",
+                          "TC messages emission interval below LowSpeedThreshold.",
+                          TimeValue(Seconds(7.0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_lowSpeedTcInterval),
+                          MakeTimeChecker())
+            .AddAttribute("MediumSpeedTcInterval",
+                          "TC messages emission interval between the speed thresholds.",
+                          TimeValue(Seconds(5.0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_mediumSpeedTcInterval),
+                          MakeTimeChecker())
+            .AddAttribute("HighSpeedTcInterval",
+                          "TC messages emission interval above HighSpeedThreshold.",
+                          TimeValue(Seconds(3.0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_highSpeedTcInterval),
+                          MakeTimeChecker())
+            .AddAttribute("DeadReckoningThreshold",
+                          "Maximum error, in meters, of the positions that receivers extrapolate "
+                          "from the last advertised position and velocity. HELLO and TC messages "
+                          "leave the position out while the error stays below it. "
+                          "0 advertises the position in every message.",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&RoutingProtocol::m_deadReckoningThreshold),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("DeadReckoningRefreshInterval",
+                          "Maximum time between two advertisements of the position when dead "
+                          "reckoning is enabled, so that new neighbors learn it.",
+                          TimeValue(Seconds(10)),
+                          MakeTimeAccessor(&RoutingProtocol::m_deadReckoningRefreshInterval),
+                          MakeTimeChecker())
+            .AddAttribute("RouteRefreshDistance",
+                          "Distance, in meters, that this node or the nodes whose position is "
+                          "extrapolated may move before the routing table is recomputed, as the "
+                          "route costs depend on the node positions.",
+                          DoubleValue(10),
+                          MakeDoubleAccessor(&RoutingProtocol::m_routeRefreshDistance),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("ExpiryCoalescingWindow",
+                          "Time by which the MPR and routing table computation following a "
+                          "neighbor loss is delayed, so that the losses falling within it share "
+                          "a single computation. 0 computes after each expiry sweep.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_expiryCoalescingWindow),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("ForwardingHoldTime",
+                          "Extra time a forwarded message may wait in the outgoing queue, so that "
+                          "it can be piggybacked with other messages.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_forwardingHoldTime),
+                          MakeTimeChecker(Seconds(0)))
             .AddTraceSource("Rx",
                             "Receive OLSR packet.",
                             MakeTraceSourceAccessor(&RoutingProtocol::m_rxPacketTrace),
@@ -251,33 +392,57 @@ RoutingProtocol::GetTypeId()
             .AddTraceSource("RoutingTableChanged",
                             "The OLSR routing table has changed.",
                             MakeTraceSourceAccessor(&RoutingProtocol::m_routingTableChanged),
-                            "ns3::olsr::RoutingProtocol::TableChangeTracedCallback");
+                            "ns3::olsr::RoutingProtocol::TableChangeTracedCallback")
+            .AddTraceSource("ExpiryQueueSize",
+                            "Number of pending tuple expirations.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_expiryQueueSize),
+                            "ns3::TracedValueCallback::Uint32")
+            .AddTraceSource("CoalescedRecomputations",
+                            "An expiry sweep handled several neighbor losses with a single MPR "
+                            "and routing table computation.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_recomputationsSavedTrace),
+                            "ns3::olsr::RoutingProtocol::CoalescedRecomputationsTracedCallback")
+            .AddTraceSource("PacketPacking",
+                            "Queued messages were packed into a packet.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_packetPackingTrace),
+                            "ns3::olsr::RoutingProtocol::PacketPackingTracedCallback");
     return tid;
 }
 
 RoutingProtocol::RoutingProtocol()
     : m_routingTableAssociation(nullptr),
+      m_lastPosition(Vector(0, 0, 0)),
+      m_lastPositionTime(Seconds(0)),
+      m_speed(0),
+      m_speedBand(SpeedBand::LOW),
+      m_fisheyeIndex(0),
+      m_tcsSinceFullRefresh(0),
+      m_lastTcAnsn(0),
+      m_lastTcTtl(0),
       m_ipv4(nullptr),
+      m_mprSetDirty(true),
+      m_mprNeighborhoodVersion(0),
+      m_skippedMprComputations(0),
       m_helloTimer(Timer::CANCEL_ON_DESTROY),
       m_tcTimer(Timer::CANCEL_ON_DESTROY),
       m_midTimer(Timer::CANCEL_ON_DESTROY),
       m_hnaTimer(Timer::CANCEL_ON_DESTROY),
+      m_expiryOrder(0),
+      m_expiryGeneration(0),
+      m_expiryCompactSize(OLSR_EXPIRY_COMPACT_MIN_SIZE),
+      m_expiryQueueSize(0),
+      m_expiryTimer(Timer::CANCEL_ON_DESTROY),
+      m_expirySweep(false),
+      m_expiryLosses(0),
+      m_lossTimer(Timer::CANCEL_ON_DESTROY),
+      m_coalescedRecomputations(0),
       m_queuedMessagesTimer(Timer::CANCEL_ON_DESTROY),
-      m_lastPosition(Vector(0, 0, 0)),
-      m_lastPositionTime(Seconds(0)),
-      m_speed(0),
-      m_lowSpeedThreshold(25.0),  // n m/s
-      m_highSpeedThreshold(40.0), // n m/s
-      m_lowSpeedHelloInterval(Seconds(2.0)),
-      m_mediumSpeedHelloInterval(Seconds(1.0)),
-      m_highSpeedHelloInterval(Seconds(0.5)),
-      m_lowSpeedTcInterval(Seconds(7.0)),
-      m_mediumSpeedTcInterval(Seconds(5.0)),
-      m_highSpeedTcInterval(Seconds(3.0))
+      m_maxPacketSize(std::numeric_limits<uint32_t>::max()),
+      m_packetsSent(0),
+      m_packedBytes(0),
+      m_degreesVersion(0)
 {
     m_uniformRandomVariable = CreateObject<UniformRandomVariable>();
-
-    m_hnaRoutingTable = Create<Ipv4StaticRouting>();
 }
 
 Vector
@@ -295,22 +460,105 @@ RoutingProtocol::GetPosition() const
     }
 }
 
+Vector
+RoutingProtocol::GetVelocity() const
+{
+    Ptr<MobilityModel> mobility = m_ipv4->GetObject<MobilityModel>();
+    if (mobility)
+    {
+        return mobility->GetVelocity();
+    }
+    return Vector(0, 0, 0);
+}
+
 void
-RoutingProtocol::UpdateNodePosition(const Ipv4Address& addr, const Vector& position)
+RoutingProtocol::FillPositionInfo(olsr::MessageHeader::PositionInfo& positionInfo,
+                                  AdvertisedMotion& advertised)
 {
-    m_nodePositions[addr] = position;
+    Vector position = GetPosition();
+    Time now = Simulator::Now();
+    if (m_deadReckoningThreshold <= 0)
+    {
+        positionInfo.SetPosition(position, m_positionOrigin, m_positionResolution);
+        positionInfo.SetTime(now);
+        return;
+    }
+
+    if (advertised.valid && now - advertised.time < m_deadReckoningRefreshInterval)
+    {
+        // Position the receivers extrapolate from the last advertisement
+        double dt = (now - advertised.time).GetSeconds();
+        Vector estimate(advertised.position.x + advertised.velocity.x * dt,
+                        advertised.position.y + advertised.velocity.y * dt,
+                        advertised.position.z + advertised.velocity.z * dt);
+        if (CalculateDistance(estimate, position) <= m_deadReckoningThreshold)
+        {
+            NS_LOG_LOGIC("Node " << m_mainAddress << " position suppressed, estimate is off by "
+                                 << CalculateDistance(estimate, position) << " m");
+            return;
+        }
+    }
+
+    positionInfo.SetPosition(position, m_positionOrigin, m_positionResolution);
+    positionInfo.SetTime(now);
+    positionInfo.SetVelocity(GetVelocity());
+
+    // Remember what the receivers decode, not the exact values
+    advertised.position = positionInfo.GetPosition(m_positionOrigin, m_positionResolution);
+    advertised.velocity = positionInfo.GetVelocity();
+    advertised.time = positionInfo.GetTime(now);
+    advertised.valid = true;
+}
+
+void
+RoutingProtocol::ProcessPositionInfo(const Ipv4Address& originator,
+                                     const olsr::MessageHeader::PositionInfo& positionInfo,
+                                     Time expirationTime)
+{
+    if (positionInfo.HasPosition())
+    {
+        UpdateNodePosition(originator,
+                           positionInfo.GetPosition(m_positionOrigin, m_positionResolution),
+                           positionInfo.GetVelocity(),
+                           positionInfo.GetTime(Simulator::Now()),
+                           expirationTime);
+    }
+    else if (!m_state.RefreshNodePosition(originator, expirationTime))
+    {
+        NS_LOG_LOGIC("No position of " << originator << " to extrapolate yet");
+    }
+}
+
+void
+RoutingProtocol::UpdateNodePosition(const Ipv4Address& addr,
+                                    const Vector& position,
+                                    const Vector& velocity,
+                                    Time updateTime,
+                                    Time expirationTime)
+{
+    bool known = (m_state.FindNodePosition(addr) >= 0);
+    if (m_state.UpdateNodePosition(addr, position, velocity, updateTime, expirationTime))
+    {
+        // Route costs depend on the node positions
+        m_routingTableDirty = true;
+    }
+    if (!known)
+    {
+        // Schedules node position deletion
+        ScheduleExpiry(expirationTime, ExpiryKind::NODE_POSITION, 0, addr);
+    }
 }
 
 Vector
 RoutingProtocol::GetNodePosition(const Ipv4Address& addr) const
 {
-    auto it = m_nodePositions.find(addr);
-    if (it != m_nodePositions.end())
+    int32_t index = m_state.FindNodePosition(addr);
+    if (index >= 0)
     {
-        return it->second;
+        return m_state.GetNodePosition(index, Simulator::Now());
     }
-    // 위치 정보가 없는 경우 기본값 반환 또는 에러 처리
-    NS_LOG_WARN("Position for node " << addr << " not found.");
+    // 위치 정보가 없는 경우 기본값 반환
+    NS_LOG_LOGIC("Position for node " << addr << " not found.");
     return Vector(0, 0, 0);
 }
 
@@ -344,34 +592,77 @@ RoutingProtocol::CalculateSpeed()
     }
 }
 
+RoutingProtocol::SpeedBand
+RoutingProtocol::ClassifySpeed(double speed, SpeedBand current) const
+{
+    // A node enters a faster band at its threshold, but only falls back to a
+    // slower band once it is m_speedHysteresis below that threshold.
+    if (speed >= m_highSpeedThreshold ||
+        (current == SpeedBand::HIGH && speed >= m_highSpeedThreshold - m_speedHysteresis))
+    {
+        return SpeedBand::HIGH;
+    }
+    if (speed >= m_lowSpeedThreshold ||
+        (current != SpeedBand::LOW && speed >= m_lowSpeedThreshold - m_speedHysteresis))
+    {
+        return SpeedBand::MEDIUM;
+    }
+    return SpeedBand::LOW;
+}
+
 void
-RoutingProtocol::AdjustTimers()
+RoutingProtocol::ApplySpeedBand(SpeedBand band)
 {
-    if (m_speed < m_lowSpeedThreshold)
+    Time helloInterval = m_lowSpeedHelloInterval;
+    Time tcInterval = m_lowSpeedTcInterval;
+    if (band == SpeedBand::MEDIUM)
     {
-        m_helloInterval = m_lowSpeedHelloInterval;
-        m_tcInterval = m_lowSpeedTcInterval;
+        helloInterval = m_mediumSpeedHelloInterval;
+        tcInterval = m_mediumSpeedTcInterval;
     }
-    else if (m_speed < m_highSpeedThreshold)
+    else if (band == SpeedBand::HIGH)
     {
-        m_helloInterval = m_mediumSpeedHelloInterval;
-        m_tcInterval = m_mediumSpeedTcInterval;
+        helloInterval = m_highSpeedHelloInterval;
+        tcInterval = m_highSpeedTcInterval;
     }
-    else
+
+    RearmTimer(m_helloTimer, m_helloInterval, helloInterval);
+    RearmTimer(m_tcTimer, m_tcInterval, tcInterval);
+    m_helloInterval = helloInterval;
+    m_tcInterval = tcInterval;
+    m_speedBand = band;
+}
+
+void
+RoutingProtocol::RearmTimer(Timer& timer, Time oldInterval, Time newInterval)
+{
+    if (oldInterval == newInterval || !timer.IsRunning())
     {
-        m_helloInterval = m_highSpeedHelloInterval;
-        m_tcInterval = m_highSpeedTcInterval;
+        // A stopped timer is scheduled with the new interval by its expire function
+        return;
     }
 
-    m_helloTimer.Cancel();
-    m_tcTimer.Cancel();
+    // Keep the time of the last emission: the next one is due one new interval after it
+    Time elapsed = oldInterval - timer.GetDelayLeft();
+    Time delay = (newInterval > elapsed) ? newInterval - elapsed : Seconds(0);
+    timer.Cancel();
+    timer.Schedule(delay);
+}
 
-    m_helloTimer.Schedule(m_helloInterval);
-    m_tcTimer.Schedule(m_tcInterval);
+void
+RoutingProtocol::AdjustTimers()
+{
+    SpeedBand band = ClassifySpeed(m_speed, m_speedBand);
+    if (band == m_speedBand)
+    {
+        return;
+    }
 
-    NS_LOG_DEBUG("Node " << m_mainAddress << " adjusted HELLO interval: " 
-                 << m_helloInterval.GetSeconds() << "s, TC interval: " 
-                 << m_tcInterval.GetSeconds() << "s");
+    ApplySpeedBand(band);
+
+    NS_LOG_DEBUG("Node " << m_mainAddress << " speed " << m_speed
+                         << " m/s, adjusted HELLO interval: " << m_helloInterval.As(Time::S)
+                         << ", TC interval: " << m_tcInterval.As(Time::S));
 }
 
 RoutingProtocol::~RoutingProtocol()
@@ -388,6 +679,8 @@ RoutingProtocol::SetIpv4(Ptr<Ipv4> ipv4)
     m_tcTimer.SetFunction(&RoutingProtocol::TcTimerExpire, this);
     m_midTimer.SetFunction(&RoutingProtocol::MidTimerExpire, this);
     m_hnaTimer.SetFunction(&RoutingProtocol::HnaTimerExpire, this);
+    m_expiryTimer.SetFunction(&RoutingProtocol::ExpiryTimerExpire, this);
+    m_lossTimer.SetFunction(&RoutingProtocol::LossTimerExpire, this);
     m_queuedMessagesTimer.SetFunction(&RoutingProtocol::SendQueuedMessages, this);
 
     m_packetSequenceNumber = OLSR_MAX_SEQ_NUM;
@@ -395,17 +688,17 @@ RoutingProtocol::SetIpv4(Ptr<Ipv4> ipv4)
     m_ansn = OLSR_MAX_SEQ_NUM;
 
     m_linkTupleTimerFirstTime = true;
+    m_routingTableDirty = true;
 
     m_ipv4 = ipv4;
-
-    m_hnaRoutingTable->SetIpv4(ipv4);
 }
 
 void
 RoutingProtocol::DoDispose()
 {
     m_ipv4 = nullptr;
-    m_hnaRoutingTable = nullptr;
+    m_hnaRoutingTable.Clear();
+    m_hnaRoutingTableBuffer.Clear();
     m_routingTableAssociation = nullptr;
 
     if (m_recvSocket)
@@ -419,7 +712,15 @@ RoutingProtocol::DoDispose()
         iter->first->Close();
     }
     m_sendSockets.clear();
-    m_table.clear();
+    m_broadcastDestinations.clear();
+    Clear();
+    m_routeCache.clear();
+
+    // Drops every pending tuple expiration along with the single event serving them
+    m_expiryTimer.Cancel();
+    m_lossTimer.Cancel();
+    m_expiryQueue = {};
+    m_expiryQueueSize = 0;
 
     Ipv4RoutingProtocol::DoDispose();
 }
@@ -443,32 +744,33 @@ RoutingProtocol::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit u
     *os << std::setw(16) << "Interface";
     *os << "Distance" << std::endl;
 
-    for (auto iter = m_table.begin(); iter != m_table.end(); iter++)
+    for (const RoutingTableEntry& entry : GetRoutingTableEntries())
     {
         std::ostringstream dest;
         std::ostringstream nextHop;
-        dest << iter->first;
-        nextHop << iter->second.nextAddr;
+        dest << entry.destAddr;
+        nextHop << entry.nextAddr;
         *os << std::setw(16) << dest.str();
         *os << std::setw(16) << nextHop.str();
         *os << std::setw(16);
-        if (!Names::FindName(m_ipv4->GetNetDevice(iter->second.interface)).empty())
+        if (!Names::FindName(m_ipv4->GetNetDevice(entry.interface)).empty())
         {
-            *os << Names::FindName(m_ipv4->GetNetDevice(iter->second.interface));
+            *os << Names::FindName(m_ipv4->GetNetDevice(entry.interface));
         }
         else
         {
-            *os << iter->second.interface;
+            *os << entry.interface;
         }
-        *os << iter->second.distance << std::endl;
+        *os << entry.distance << std::endl;
     }
     *os << std::endl;
 
     // Also print the HNA routing table
-    if (m_hnaRoutingTable->GetNRoutes() > 0)
+    if (m_hnaRoutingTable.GetNRoutes() > 0)
     {
         *os << "HNA Routing Table:" << std::endl;
-        m_hnaRoutingTable->PrintRoutingTable(stream, unit);
+        m_hnaRoutingTable.Print(*os);
+        *os << std::endl;
     }
     else
     {
@@ -555,13 +857,40 @@ RoutingProtocol::DoInitialize()
             NS_FATAL_ERROR("Failed to bind() OLSR socket");
         }
         socket->SetRecvPktInfo(true);
-        m_sendSockets[socket] = m_ipv4->GetAddress(i, 0);
+        Ipv4InterfaceAddress ifaceAddr = m_ipv4->GetAddress(i, 0);
+        m_sendSockets[socket] = ifaceAddr;
+        Ipv4Address bcast = ifaceAddr.GetLocal().GetSubnetDirectedBroadcast(ifaceAddr.GetMask());
+        m_broadcastDestinations.emplace_back(socket, InetSocketAddress(bcast, OLSR_PORT_NUMBER));
+        m_maxPacketSize =
+            std::min<uint32_t>(m_maxPacketSize, m_ipv4->GetMtu(i) - OLSR_IP_UDP_HEADER_SIZE);
 
         canRunOlsr = true;
     }
 
+    m_fisheyeTtls.clear();
+    std::istringstream fisheyeTtls(m_fisheyeTtlList);
+    std::string ttl;
+    while (std::getline(fisheyeTtls, ttl, ','))
+    {
+        char* end = nullptr;
+        unsigned long value = std::strtoul(ttl.c_str(), &end, 10);
+        if (ttl.empty() || *end != '\0' || value == 0 || value > 255)
+        {
+            NS_FATAL_ERROR("Invalid TTL \"" << ttl << "\" in FisheyeTtls");
+        }
+        m_fisheyeTtls.push_back(value);
+    }
+
     if (canRunOlsr)
     {
+        // The first speed estimate is measured from the starting position
+        m_lastPosition = GetPosition();
+        m_lastPositionTime = Simulator::Now();
+        if (m_adaptiveTimers)
+        {
+            ApplySpeedBand(ClassifySpeed(0, SpeedBand::LOW));
+        }
+
         HelloTimerExpire();
         TcTimerExpire();
         MidTimerExpire();
@@ -633,46 +962,61 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
     NS_ASSERT(olsrPacketHeader.GetPacketLength() >= olsrPacketHeader.GetSerializedSize());
     uint32_t sizeLeft = olsrPacketHeader.GetPacketLength() - olsrPacketHeader.GetSerializedSize();
 
-    MessageList messages;
+    // Only the fixed header fields of the messages are decoded at first. They are read from a
+    // copy of the packet, which shares its bytes and is consumed along the way
+    Ptr<Packet> remaining = packet->Copy();
+    std::vector<MessageView> views;
+    uint32_t offset = 0;
 
     while (sizeLeft)
     {
-        MessageHeader messageHeader;
-        if (packet->RemoveHeader(messageHeader) == 0)
+        MessageView view;
+        uint8_t header[MessageView::HEADER_SIZE] = {};
+        remaining->CopyData(header, MessageView::HEADER_SIZE);
+        uint32_t available = std::min<uint32_t>(sizeLeft, remaining->GetSize());
+        uint32_t messageSize = view.Parse(packet, offset, header, available);
+        if (messageSize == 0)
         {
-            NS_ASSERT(false);
+            NS_LOG_DEBUG("Malformed OLSR message, dropping the rest of the packet.");
+            break;
         }
 
-        sizeLeft -= messageHeader.GetSerializedSize();
+        remaining->RemoveAtStart(messageSize);
+        offset += messageSize;
+        sizeLeft -= messageSize;
 
         NS_LOG_DEBUG("Olsr Msg received with type "
-                     << std::dec << int(messageHeader.GetMessageType())
-                     << " TTL=" << int(messageHeader.GetTimeToLive())
-                     << " origAddr=" << messageHeader.GetOriginatorAddress());
-        messages.push_back(messageHeader);
+                     << std::dec << int(view.GetMessageType())
+                     << " TTL=" << int(view.GetTimeToLive())
+                     << " origAddr=" << view.GetOriginatorAddress());
+        views.push_back(view);
     }
 
-    m_rxPacketTrace(olsrPacketHeader, messages);
+    // The whole messages are only decoded for the trace sinks, if any
+    if (!m_rxPacketTrace.IsEmpty())
+    {
+        MessageList messages(views.size());
+        for (uint32_t i = 0; i < views.size(); i++)
+        {
+            views[i].Materialize(messages[i]);
+        }
+        m_rxPacketTrace(olsrPacketHeader, messages);
+    }
 
-    for (auto messageIter = messages.begin(); messageIter != messages.end(); messageIter++)
+    for (MessageView& view : views)
     {
-        const MessageHeader& messageHeader = *messageIter;
         // If ttl is less than or equal to zero, or
         // the receiver is the same as the originator,
         // the message must be silently dropped
-        if (messageHeader.GetTimeToLive() == 0 ||
-            messageHeader.GetOriginatorAddress() == m_mainAddress)
+        if (view.GetTimeToLive() == 0 || view.GetOriginatorAddress() == m_mainAddress)
         {
-            packet->RemoveAtStart(messageHeader.GetSerializedSize() -
-                                  messageHeader.GetSerializedSize());
             continue;
         }
 
         // If the message has been processed it must not be processed again
         bool do_forwarding = true;
-        DuplicateTuple* duplicated =
-            m_state.FindDuplicateTuple(messageHeader.GetOriginatorAddress(),
-                                       messageHeader.GetMessageSequenceNumber());
+        bool duplicated =
+            m_state.IsDuplicate(view.GetOriginatorAddress(), view.GetMessageSequenceNumber());
 
         // Get main address of the peer, which may be different from the packet source address
         //       const IfaceAssocTuple *ifaceAssoc = m_state.FindIfaceAssocTuple
@@ -685,8 +1029,10 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
         //           peerMainAddress = inetSourceAddr.GetIpv4 () ;
         //         }
 
-        if (duplicated == nullptr)
+        if (!duplicated)
         {
+            MessageHeader messageHeader;
+            view.Materialize(messageHeader);
             switch (messageHeader.GetMessageType())
             {
             case olsr::MessageHeader::HELLO_MESSAGE:
@@ -727,13 +1073,11 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
 
             // If the message has been considered for forwarding, it should
             // not be retransmitted again
-            for (auto it = duplicated->ifaceList.begin(); it != duplicated->ifaceList.end(); it++)
+            if (m_state.IsDuplicateOnInterface(view.GetOriginatorAddress(),
+                                               view.GetMessageSequenceNumber(),
+                                               recvInterfaceIndex))
             {
-                if (*it == receiverIfaceAddr)
-                {
-                    do_forwarding = false;
-                    break;
-                }
+                do_forwarding = false;
             }
         }
 
@@ -742,23 +1086,31 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
             // HELLO messages are never forwarded.
             // TC and MID messages are forwarded using the default algorithm.
             // Remaining messages are also forwarded using the default algorithm.
-            if (messageHeader.GetMessageType() != olsr::MessageHeader::HELLO_MESSAGE)
+            if (view.GetMessageType() != olsr::MessageHeader::HELLO_MESSAGE)
             {
-                ForwardDefault(messageHeader,
-                               duplicated,
-                               receiverIfaceAddr,
-                               inetSourceAddr.GetIpv4());
+                ForwardDefault(view, duplicated, recvInterfaceIndex, inetSourceAddr.GetIpv4());
             }
         }
     }
 
-    // After processing all OLSR messages, we must recompute the routing table
-    RoutingTableComputation();
+    // After processing all OLSR messages, we must recompute the routing table,
+    // unless the messages only refreshed the holding times of known tuples
+    if (m_routingTableDirty)
+    {
+        RoutingTableComputation();
+    }
+    else
+    {
+        NS_LOG_DEBUG("Node " << m_mainAddress << ": routing table is up to date.");
+    }
 }
 
 ///
 /// \brief This auxiliary function (defined in \RFC{3626}) is used for calculating the MPR Set.
 ///
+/// The degrees of all the neighbors are computed together and cached until the neighbor or
+/// 2-hop neighbor sets change.
+///
 /// \param tuple the neighbor tuple which has the main address of the node we are going to calculate
 /// its degree to.
 /// \return the degree of the node.
@@ -766,58 +1118,141 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
 int
 RoutingProtocol::Degree(const NeighborTuple& tuple)
 {
-    int degree = 0;
-    for (auto it = m_state.GetTwoHopNeighbors().begin(); it != m_state.GetTwoHopNeighbors().end();
-         it++)
+    if (m_degreesVersion != m_state.GetNeighborhoodVersion())
     {
-        const TwoHopNeighborTuple& nb2hop_tuple = *it;
-        if (nb2hop_tuple.neighborMainAddr == tuple.neighborMainAddr)
+        // The degrees only depend on the neighbor and 2-hop neighbor sets: compute all of them
+        // in a single pass, and reuse them until these sets change.
+        m_degrees.clear();
+        for (auto it = m_state.GetTwoHopNeighbors().begin();
+             it != m_state.GetTwoHopNeighbors().end();
+             it++)
         {
+            const TwoHopNeighborTuple& nb2hop_tuple = *it;
             const NeighborTuple* nb_tuple =
                 m_state.FindNeighborTuple(nb2hop_tuple.neighborMainAddr);
             if (nb_tuple == nullptr)
             {
-                degree++;
+                m_degrees[nb2hop_tuple.neighborMainAddr]++;
             }
         }
+        m_degreesVersion = m_state.GetNeighborhoodVersion();
+    }
+
+    auto degree = m_degrees.find(tuple.neighborMainAddr);
+    if (degree == m_degrees.end())
+    {
+        return 0;
     }
-    return degree;
+    return degree->second;
 }
 
 namespace
 {
 ///
-/// \brief Remove all covered 2-hop neighbors from N2 set.
-/// This is a helper function used by MprComputation algorithm.
+/// \brief Set of 2-hop neighbors, stored as a bitset over dense 2-hop neighbor indices.
+/// This is a helper class used by MprComputation algorithm.
 ///
-/// \param neighborMainAddr Neighbor main address.
-/// \param N2 Reference to the 2-hop neighbor set.
-///
-void
-CoverTwoHopNeighbors(Ipv4Address neighborMainAddr, TwoHopNeighborSet& N2)
+class TwoHopNeighborBitset
 {
-    // first gather all 2-hop neighbors to be removed
-    std::set<Ipv4Address> toRemove;
-    for (auto twoHopNeigh = N2.begin(); twoHopNeigh != N2.end(); twoHopNeigh++)
+  public:
+    /**
+     * \brief Constructor.
+     * \param size The number of 2-hop neighbors the set can hold.
+     */
+    explicit TwoHopNeighborBitset(std::size_t size)
+        : m_words((size + 63) / 64, 0)
+    {
+    }
+
+    /**
+     * \brief Adds a 2-hop neighbor to the set.
+     * \param index The 2-hop neighbor index.
+     * \return true if the 2-hop neighbor was not in the set yet.
+     */
+    bool Insert(std::size_t index)
+    {
+        uint64_t& word = m_words[index / 64];
+        uint64_t bit = uint64_t(1) << (index % 64);
+        bool inserted = (word & bit) == 0;
+        word |= bit;
+        return inserted;
+    }
+
+    /**
+     * \brief Tests whether a 2-hop neighbor is in the set.
+     * \param index The 2-hop neighbor index.
+     * \return true if the 2-hop neighbor is in the set.
+     */
+    bool Contains(std::size_t index) const
     {
-        if (twoHopNeigh->neighborMainAddr == neighborMainAddr)
+        return (m_words[index / 64] & (uint64_t(1) << (index % 64))) != 0;
+    }
+
+    /**
+     * \brief Adds all the members of another set.
+     * \param other The other set.
+     */
+    void Merge(const TwoHopNeighborBitset& other)
+    {
+        for (std::size_t i = 0; i < m_words.size(); i++)
         {
-            toRemove.insert(twoHopNeigh->twoHopNeighborAddr);
+            m_words[i] |= other.m_words[i];
         }
     }
-    // Now remove all matching records from N2
-    for (auto twoHopNeigh = N2.begin(); twoHopNeigh != N2.end();)
+
+    /**
+     * \brief Removes all the members of another set.
+     * \param other The other set.
+     */
+    void Remove(const TwoHopNeighborBitset& other)
     {
-        if (toRemove.find(twoHopNeigh->twoHopNeighborAddr) != toRemove.end())
+        for (std::size_t i = 0; i < m_words.size(); i++)
         {
-            twoHopNeigh = N2.erase(twoHopNeigh);
+            m_words[i] &= ~other.m_words[i];
         }
-        else
+    }
+
+    /**
+     * \brief Counts the members shared with another set.
+     * \param other The other set.
+     * \return The size of the intersection of both sets.
+     */
+    std::size_t CountCommon(const TwoHopNeighborBitset& other) const
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < m_words.size(); i++)
         {
-            twoHopNeigh++;
+            count += std::bitset<64>(m_words[i] & other.m_words[i]).count();
         }
+        return count;
     }
-}
+
+    /**
+     * \return The number of members.
+     */
+    std::size_t Count() const
+    {
+        return CountCommon(*this);
+    }
+
+    /**
+     * \return true if the set has no members.
+     */
+    bool IsEmpty() const
+    {
+        for (std::size_t i = 0; i < m_words.size(); i++)
+        {
+            if (m_words[i] != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    std::vector<uint64_t> m_words; //!< Bit words, one bit per 2-hop neighbor.
+};
 } // unnamed namespace
 
 void
@@ -831,13 +1266,15 @@ RoutingProtocol::MprComputation()
 
     // N is the subset of neighbors of the node, which are
     // neighbor "of the interface I"
-    NeighborSet N;
+    std::vector<const NeighborTuple*> N;
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> neighborIndices;
     for (auto neighbor = m_state.GetNeighbors().begin(); neighbor != m_state.GetNeighbors().end();
          neighbor++)
     {
         if (neighbor->status == NeighborTuple::STATUS_SYM) // I think that we need this check
         {
-            N.push_back(*neighbor);
+            neighborIndices.emplace(neighbor->neighborMainAddr, N.size());
+            N.push_back(&(*neighbor));
         }
     }
 
@@ -847,7 +1284,9 @@ RoutingProtocol::MprComputation()
     // (ii)  the node performing the computation
     // (iii) all the symmetric neighbors: the nodes for which there exists a symmetric
     //       link to this node on some interface.
-    TwoHopNeighborSet N2;
+    // N2 links are kept as (N index, N2 index) pairs, N2 members get dense indices.
+    std::vector<std::pair<uint32_t, uint32_t>> N2Links;
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> twoHopIndices;
     for (auto twoHopNeigh = m_state.GetTwoHopNeighbors().begin();
          twoHopNeigh != m_state.GetTwoHopNeighbors().end();
          twoHopNeigh++)
@@ -863,16 +1302,8 @@ RoutingProtocol::MprComputation()
         //  excluding:
         // (i)   the nodes only reachable by members of N with willingness Willingness::NEVER
         // 연결 의지가 'never'인 N 집합의 멤버에 의해서만 도달 가능한 노드 제외
-        bool ok = false;
-        for (auto neigh = N.begin(); neigh != N.end(); neigh++)
-        {
-            if (neigh->neighborMainAddr == twoHopNeigh->neighborMainAddr)
-            {
-                ok = (neigh->willingness != Willingness::NEVER);
-                break;
-            }
-        }
-        if (!ok)
+        auto neigh = neighborIndices.find(twoHopNeigh->neighborMainAddr);
+        if (neigh == neighborIndices.end() || N[neigh->second]->willingness == Willingness::NEVER)
         {
             continue;
         }
@@ -881,50 +1312,44 @@ RoutingProtocol::MprComputation()
         // (iii) all the symmetric neighbors: the nodes for which there exists a symmetric
         //       link to this node on some interface.
         // 모든 대칭 이웃 제외
-        for (auto neigh = N.begin(); neigh != N.end(); neigh++)
+        if (neighborIndices.find(twoHopNeigh->twoHopNeighborAddr) != neighborIndices.end())
         {
-            if (neigh->neighborMainAddr == twoHopNeigh->twoHopNeighborAddr)
-            {
-                ok = false;
-                break;
-            }
+            continue;
         }
 
-        if (ok)
-        {
-            N2.push_back(*twoHopNeigh);
-        }
+        auto twoHop = twoHopIndices.emplace(twoHopNeigh->twoHopNeighborAddr, twoHopIndices.size());
+        N2Links.emplace_back(neigh->second, twoHop.first->second);
+        NS_LOG_DEBUG("N2: " << twoHopNeigh->neighborMainAddr << "->"
+                            << twoHopNeigh->twoHopNeighborAddr);
     }
 
-#ifdef NS3_LOG_ENABLE
+    // Coverage of each member of N, number of members of N covering each member of N2
+    // and, for N2 members covered by a single neighbor, that neighbor.
+    const std::size_t n2Size = twoHopIndices.size();
+    std::vector<TwoHopNeighborBitset> coverage(N.size(), TwoHopNeighborBitset(n2Size));
+    std::vector<uint32_t> coverCount(n2Size, 0);
+    std::vector<uint32_t> coveringNeighbor(n2Size, 0);
+    TwoHopNeighborBitset uncovered(n2Size);
+    for (auto link = N2Links.begin(); link != N2Links.end(); link++)
     {
-        std::ostringstream os;
-        os << "[";
-        for (auto iter = N2.begin(); iter != N2.end(); iter++)
+        if (coverage[link->first].Insert(link->second))
         {
-            auto next = iter;
-            next++;
-            os << iter->neighborMainAddr << "->" << iter->twoHopNeighborAddr;
-            if (next != N2.end())
-            {
-                os << ", ";
-            }
+            coverCount[link->second]++;
+            coveringNeighbor[link->second] = link->first;
         }
-        os << "]";
-        NS_LOG_DEBUG("N2: " << os.str());
+        uncovered.Insert(link->second);
     }
-#endif // NS3_LOG_ENABLE
 
     // 1. Start with an MPR set made of all members of N with
     // N_willingness equal to Willingness::ALWAYS
-    for (auto neighbor = N.begin(); neighbor != N.end(); neighbor++)
+    for (uint32_t i = 0; i < N.size(); i++)
     {
-        if (neighbor->willingness == Willingness::ALWAYS) // willingness가 always인 노드를 MPR 세트에 포함
+        if (N[i]->willingness == Willingness::ALWAYS) // willingness가 always인 노드를 MPR 세트에 포함
         {
-            mprSet.insert(neighbor->neighborMainAddr);
+            mprSet.insert(N[i]->neighborMainAddr);
             // (not in RFC but I think is needed: remove the 2-hop
             // neighbors reachable by the MPR from N2)
-            CoverTwoHopNeighbors(neighbor->neighborMainAddr, N2); // MPR을 통해 접근 가능한 2-hop 이웃들을 N2에서 제외
+            uncovered.Remove(coverage[i]); // MPR을 통해 접근 가능한 2-hop 이웃들을 N2에서 제외
         }
     }
 
@@ -933,107 +1358,38 @@ RoutingProtocol::MprComputation()
 
     // 3. Add to the MPR set those nodes in N, which are the *only*
     // nodes to provide reachability to a node in N2.
-    std::set<Ipv4Address> coveredTwoHopNeighbors;
-    for (auto twoHopNeigh = N2.begin(); twoHopNeigh != N2.end(); twoHopNeigh++)
+    TwoHopNeighborBitset coveredTwoHopNeighbors(n2Size);
+    for (uint32_t j = 0; j < n2Size; j++)
     {
-        bool onlyOne = true;
-        // try to find another neighbor that can reach twoHopNeigh->twoHopNeighborAddr
         // 오직 N2에 하나만 도달할 수 있는지 체크
-        // 새로운 2홉 이웃을 설정한 후 타겟 2홉 이웃의 주소가 같으면서 N의 주소가 다른 노드를 찾아서 onlyOne을 false로 만듦
-        for (auto otherTwoHopNeigh = N2.begin(); otherTwoHopNeigh != N2.end(); otherTwoHopNeigh++)
-        {
-            if (otherTwoHopNeigh->twoHopNeighborAddr == twoHopNeigh->twoHopNeighborAddr &&
-                otherTwoHopNeigh->neighborMainAddr != twoHopNeigh->neighborMainAddr)
-            {
-                onlyOne = false;
-                break;
-            }
-        }
-        if (onlyOne)
+        if (uncovered.Contains(j) && coverCount[j] == 1)
         {
-            NS_LOG_LOGIC("Neighbor " << twoHopNeigh->neighborMainAddr
-                                     << " is the only that can reach 2-hop neigh. "
-                                     << twoHopNeigh->twoHopNeighborAddr << " => select as MPR.");
+            const NeighborTuple* onlyOne = N[coveringNeighbor[j]];
+            NS_LOG_LOGIC("Neighbor " << onlyOne->neighborMainAddr
+                                     << " is the only that can reach a 2-hop neigh."
+                                     << " => select as MPR.");
 
-            mprSet.insert(twoHopNeigh->neighborMainAddr);
+            mprSet.insert(onlyOne->neighborMainAddr);
 
             // take note of all the 2-hop neighbors reachable by the newly elected MPR
             // 새로 선출된 MPR에 의해 도달 가능한 모든 2-hop 이웃들이 coverdTwoHopNeighbors에 기록
-            for (auto otherTwoHopNeigh = N2.begin(); otherTwoHopNeigh != N2.end();
-                 otherTwoHopNeigh++)
-            {
-                if (otherTwoHopNeigh->neighborMainAddr == twoHopNeigh->neighborMainAddr)
-                {
-                    coveredTwoHopNeighbors.insert(otherTwoHopNeigh->twoHopNeighborAddr);
-                }
-            }
+            coveredTwoHopNeighbors.Merge(coverage[coveringNeighbor[j]]);
         }
     }
     // Remove the nodes from N2 which are now covered by a node in the MPR set.
     // N2에서 커버된 노드 제거
-    for (auto twoHopNeigh = N2.begin(); twoHopNeigh != N2.end();)
-    {
-        if (coveredTwoHopNeighbors.find(twoHopNeigh->twoHopNeighborAddr) !=
-            coveredTwoHopNeighbors.end())
-        {
-            // This works correctly only because it is known that twoHopNeigh is reachable by
-            // exactly one neighbor, so only one record in N2 exists for each of them. This record
-            // is erased here.
-            NS_LOG_LOGIC("2-hop neigh. " << twoHopNeigh->twoHopNeighborAddr
-                                         << " is already covered by an MPR.");
-            twoHopNeigh = N2.erase(twoHopNeigh);
-        }
-        else
-        {
-            twoHopNeigh++;
-        }
-    }
+    uncovered.Remove(coveredTwoHopNeighbors);
 
     // 4. While there exist nodes in N2 which are not covered by at
     // least one node in the MPR set:
-    while (N2.begin() != N2.end())
+    while (!uncovered.IsEmpty())
     {
-#ifdef NS3_LOG_ENABLE
-        {
-            std::ostringstream os;
-            os << "[";
-            for (auto iter = N2.begin(); iter != N2.end(); iter++)
-            {
-                auto next = iter;
-                next++;
-                os << iter->neighborMainAddr << "->" << iter->twoHopNeighborAddr;
-                if (next != N2.end())
-                {
-                    os << ", ";
-                }
-            }
-            os << "]";
-            NS_LOG_DEBUG("Step 4 iteration: N2=" << os.str());
-        }
-#endif // NS3_LOG_ENABLE
+        NS_LOG_DEBUG("Step 4 iteration: " << uncovered.Count() << " 2-hop neighbors in N2");
 
         // 4.1. For each node in N, calculate the reachability, i.e., the
         // number of nodes in N2 which are not yet covered by at
         // least one node in the MPR set, and which are reachable
         // through this 1-hop neighbor
-        std::map<int, std::vector<const NeighborTuple*>> reachability;
-        std::set<int> rs;  // 유일한 도달 가능성 수치를 넣기 위한 집합
-        for (auto it = N.begin(); it != N.end(); it++)
-        {
-            const NeighborTuple& nb_tuple = *it;
-            int r = 0;
-            for (auto it2 = N2.begin(); it2 != N2.end(); it2++)
-            {
-                const TwoHopNeighborTuple& nb2hop_tuple = *it2;
-                if (nb_tuple.neighborMainAddr == nb2hop_tuple.neighborMainAddr)
-                {
-                    r++;
-                }
-            }
-            rs.insert(r); // 현재 1-홉 이웃이 도달할 수 있는 2-홉 이웃의 수
-            reachability[r].push_back(&nb_tuple);
-        }
-
         // 4.2. Select as a MPR the node with highest N_willingness among
         // the nodes in N with non-zero reachability. In case of
         // multiple choice select the node which provides
@@ -1045,48 +1401,45 @@ RoutingProtocol::MprComputation()
         // rs가 0인 아닌 노드 중 willingness가 높은 노드를 MPR로 선정
         // rs가 같은 노드의 경우 더 큰 연결도를 가진 노드로 선택
         // N2의 갯수가 0이 될때까지 반복
-        const NeighborTuple* max = nullptr;
-        int max_r = 0;
-        for (auto it = rs.begin(); it != rs.end(); it++)
+        int max = -1;
+        std::size_t max_r = 0;
+        for (uint32_t i = 0; i < N.size(); i++)
         {
-            int r = *it;
+            std::size_t r = coverage[i].CountCommon(uncovered);
             if (r == 0)
             {
                 continue;
             }
-            for (auto it2 = reachability[r].begin(); it2 != reachability[r].end(); it2++)
+            bool select = false;
+            if (max == -1 || N[i]->willingness > N[max]->willingness)
             {
-                const NeighborTuple* nb_tuple = *it2;
-                if (max == nullptr || nb_tuple->willingness > max->willingness)
+                select = true;
+            }
+            else if (N[i]->willingness == N[max]->willingness)
+            {
+                if (r > max_r)
                 {
-                    max = nb_tuple;
-                    max_r = r;
+                    select = true;
                 }
-                else if (nb_tuple->willingness == max->willingness)
+                else if (r == max_r)
                 {
-                    if (r > max_r)
-                    {
-                        max = nb_tuple;
-                        max_r = r;
-                    }
-                    else if (r == max_r)
-                    {
-                        if (Degree(*nb_tuple) > Degree(*max))
-                        {
-                            max = nb_tuple;
-                            max_r = r;
-                        }
-                    }
+                    select = Degree(*N[i]) > Degree(*N[max]);
                 }
             }
+            if (select)
+            {
+                max = i;
+                max_r = r;
+            }
         }
 
-        if (max != nullptr)
+        if (max == -1)
         {
-            mprSet.insert(max->neighborMainAddr);
-            CoverTwoHopNeighbors(max->neighborMainAddr, N2);
-            NS_LOG_LOGIC(N2.size() << " 2-hop neighbors left to cover!");
+            break;
         }
+        mprSet.insert(N[max]->neighborMainAddr);
+        uncovered.Remove(coverage[max]);
+        NS_LOG_LOGIC(uncovered.Count() << " 2-hop neighbors left to cover!");
     }
 
 #ifdef NS3_LOG_ENABLE
@@ -1109,6 +1462,21 @@ RoutingProtocol::MprComputation()
 #endif // NS3_LOG_ENABLE
 
     m_state.SetMprSet(mprSet);
+    m_mprSetDirty = false;
+    m_mprNeighborhoodVersion = m_state.GetNeighborhoodVersion();
+}
+
+void
+RoutingProtocol::UpdateMprSet()
+{
+    if (!m_mprSetDirty && m_mprNeighborhoodVersion == m_state.GetNeighborhoodVersion())
+    {
+        NS_LOG_LOGIC("Neighborhood of node " << m_mainAddress
+                                             << " unchanged, keeping the MPR set.");
+        m_skippedMprComputations++;
+        return;
+    }
+    MprComputation();
 }
 
 Ipv4Address
@@ -1126,6 +1494,85 @@ RoutingProtocol::GetMainAddress(Ipv4Address iface_addr) const
     }
 }
 
+namespace
+{
+///
+/// \brief Graph of the known topology used to compute the least-cost routes.
+///
+/// Nodes are identified by dense indices so that the shortest path search only
+/// works on vectors.
+///
+class RouteGraph
+{
+  public:
+    /// Edge of the graph.
+    struct Edge
+    {
+        uint32_t to; //!< Index of the node the edge leads to.
+        double cost; //!< Cost of the edge, not counting the distance between its nodes.
+    };
+
+    /**
+     * \brief Gets the index of a node, adding the node if it is not known yet.
+     * \param addr The main address of the node.
+     * \return The index of the node.
+     */
+    uint32_t GetIndex(const Ipv4Address& addr)
+    {
+        auto result = m_indices.emplace(addr, m_addresses.size());
+        if (result.second)
+        {
+            m_addresses.push_back(addr);
+            m_edges.emplace_back();
+        }
+        return result.first->second;
+    }
+
+    /**
+     * \brief Adds a directed edge.
+     * \param from The main address of the node the edge starts from.
+     * \param to The main address of the node the edge leads to.
+     * \param cost The cost of the edge, not counting the distance between its nodes.
+     */
+    void AddEdge(const Ipv4Address& from, const Ipv4Address& to, double cost)
+    {
+        uint32_t toIndex = GetIndex(to);
+        m_edges[GetIndex(from)].push_back({toIndex, cost});
+    }
+
+    /**
+     * \return The number of nodes.
+     */
+    uint32_t GetNNodes() const
+    {
+        return m_addresses.size();
+    }
+
+    /**
+     * \param index The index of a node.
+     * \return The main address of the node.
+     */
+    const Ipv4Address& GetAddress(uint32_t index) const
+    {
+        return m_addresses[index];
+    }
+
+    /**
+     * \param index The index of a node.
+     * \return The edges starting from the node.
+     */
+    const std::vector<Edge>& GetEdges(uint32_t index) const
+    {
+        return m_edges[index];
+    }
+
+  private:
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_indices; //!< Node indices.
+    std::vector<Ipv4Address> m_addresses;                                  //!< Node addresses.
+    std::vector<std::vector<Edge>> m_edges;                                //!< Adjacency lists.
+};
+} // unnamed namespace
+
 void
 RoutingProtocol::RoutingTableComputation()
 {
@@ -1134,10 +1581,10 @@ RoutingProtocol::RoutingTableComputation()
 
     // 1. All the entries from the routing table are removed.
     Clear();
+    m_routingTableDirty = false;
 
-    // A*를 위한 추가 데이터 구조
-    std::map<Ipv4Address, double> gScore;
-    std::map<Ipv4Address, Ipv4Address> cameFrom;
+    RouteGraph graph;
+    const uint32_t self = graph.GetIndex(m_mainAddress);
 
     // 2. The new routing entries are added starting with the
     // symmetric neighbors (h=1) as the destination nodes.
@@ -1149,97 +1596,121 @@ RoutingProtocol::RoutingTableComputation()
         NS_LOG_DEBUG("Looking at neighbor tuple: " << nb_tuple);
         if (nb_tuple.status == NeighborTuple::STATUS_SYM)
         {
-            Vector neighborPos = GetNodePosition(nb_tuple.neighborMainAddr);
-            Vector myPos = GetPosition();
-            
-            // 유클리드 거리 계산
-            double distance = CalculateDistance(myPos, neighborPos);
-
-            // HelloInterval을 추가 코스트로 사용
+            // HelloInterval을 추가 코스트로 사용 (거리는 아래에서 더함)
             double helloIntervalWeight = 20.0; // helloInterval의 값이 작기 때문에 유의미한 수치를 부여하기 위함
-            double cost = distance + (nb_tuple.helloInterval.GetSeconds() * helloIntervalWeight);
+            double cost = nb_tuple.helloInterval.GetSeconds() * helloIntervalWeight;
 
-            gScore[nb_tuple.neighborMainAddr] = cost;
-            cameFrom[nb_tuple.neighborMainAddr] = m_mainAddress;
+            graph.AddEdge(m_mainAddress, nb_tuple.neighborMainAddr, cost);
 
             AddEntry(nb_tuple.neighborMainAddr, nb_tuple.neighborMainAddr,
                      GetMainAddress(nb_tuple.neighborMainAddr), 1);
         }
     }
 
-    // 3. 2홉 이웃 노드 처리
+    // 3. 2홉 이웃 노드 처리: edges from the symmetric neighbors to the 2-hop neighbors
     const TwoHopNeighborSet& twoHopNeighbors = m_state.GetTwoHopNeighbors();
     for (auto it = twoHopNeighbors.begin(); it != twoHopNeighbors.end(); it++)
     {
         const TwoHopNeighborTuple& nb2hop_tuple = *it;
-        
+
         if (!m_state.FindSymNeighborTuple(nb2hop_tuple.twoHopNeighborAddr) &&
-            nb2hop_tuple.twoHopNeighborAddr != m_mainAddress)
+            nb2hop_tuple.twoHopNeighborAddr != m_mainAddress &&
+            m_state.FindSymNeighborTuple(nb2hop_tuple.neighborMainAddr))
         {
-            RoutingTableEntry entry;
-            bool foundEntry = Lookup(nb2hop_tuple.neighborMainAddr, entry);
-            if (foundEntry)
-            {
-                Vector myPos = GetPosition();
-                Vector neighborPos = GetNodePosition(nb2hop_tuple.neighborMainAddr);
-                Vector twoHopPos = GetNodePosition(nb2hop_tuple.twoHopNeighborAddr);
-                
-                double distance1 = CalculateDistance(myPos, neighborPos);
-                double distance2 = CalculateDistance(neighborPos, twoHopPos);
-                
-                double cost = gScore[nb2hop_tuple.neighborMainAddr] + distance2 + 
-                              nb2hop_tuple.helloInterval.GetSeconds();
-                
-                if (gScore.find(nb2hop_tuple.twoHopNeighborAddr) == gScore.end() ||
-                    cost < gScore[nb2hop_tuple.twoHopNeighborAddr])
-                {
-                    gScore[nb2hop_tuple.twoHopNeighborAddr] = cost;
-                    cameFrom[nb2hop_tuple.twoHopNeighborAddr] = nb2hop_tuple.neighborMainAddr;
-                    AddEntry(nb2hop_tuple.twoHopNeighborAddr, entry.nextAddr, entry.interface, 2);
-                }
-            }
+            graph.AddEdge(nb2hop_tuple.neighborMainAddr,
+                          nb2hop_tuple.twoHopNeighborAddr,
+                          nb2hop_tuple.helloInterval.GetSeconds());
         }
     }
 
-    // 4. 더 먼 노드들에 대한 처리
-    for (uint32_t h = 2;; h++)
+    // 4. 더 먼 노드들에 대한 처리: edges advertised in the topology set
+    const TopologySet& topology = m_state.GetTopologySet();
+    for (auto it = topology.begin(); it != topology.end(); it++)
     {
-        bool added = false;
+        const TopologyTuple& topology_tuple = *it;
+        if (topology_tuple.lastAddr == m_mainAddress)
+        {
+            continue;
+        }
 
-        const TopologySet& topology = m_state.GetTopologySet();
-        for (auto it = topology.begin(); it != topology.end(); it++)
+        graph.AddEdge(topology_tuple.lastAddr,
+                      topology_tuple.destAddr,
+                      topology_tuple.helloInterval.GetSeconds());
+    }
+
+    // Node positions, looked up once per node and extrapolated to the current time.
+    // Nodes with an unknown position are placed at the origin.
+    const uint32_t nNodes = graph.GetNNodes();
+    const Time now = Simulator::Now();
+    std::vector<Vector> positions(nNodes, Vector(0, 0, 0));
+    positions[self] = GetPosition();
+    m_routesPosition = positions[self];
+    m_routesTime = now;
+    for (uint32_t node = 0; node < nNodes; node++)
+    {
+        int32_t index = m_state.FindNodePosition(graph.GetAddress(node));
+        if (node != self && index >= 0)
         {
-            const TopologyTuple& topology_tuple = *it;
+            positions[node] = m_state.GetNodePosition(index, now);
+        }
+    }
 
-            RoutingTableEntry destAddrEntry;
-            RoutingTableEntry lastAddrEntry;
-            bool have_destAddrEntry = Lookup(topology_tuple.destAddr, destAddrEntry);
-            bool have_lastAddrEntry = Lookup(topology_tuple.lastAddr, lastAddrEntry);
+    // Least-cost search (Dijkstra) from this node. The symmetric neighbors are
+    // always reached directly, so their routes and costs are never relaxed.
+    std::vector<double> gScore(nNodes, std::numeric_limits<double>::infinity());
+    std::vector<uint32_t> hops(nNodes, 0);
+    std::vector<uint32_t> firstHop(nNodes, self);
+    std::vector<bool> fixed(nNodes, false);
 
-            if (!have_destAddrEntry && have_lastAddrEntry && lastAddrEntry.distance == h)
+    typedef std::pair<double, uint32_t> HeapItem;
+    std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> openSet;
+
+    gScore[self] = 0;
+    fixed[self] = true;
+    for (const RouteGraph::Edge& edge : graph.GetEdges(self))
+    {
+        gScore[edge.to] = CalculateDistance(positions[self], positions[edge.to]) + edge.cost;
+        hops[edge.to] = 1;
+        firstHop[edge.to] = edge.to;
+        fixed[edge.to] = true;
+        openSet.emplace(gScore[edge.to], edge.to);
+    }
+
+    while (!openSet.empty())
+    {
+        HeapItem current = openSet.top();
+        openSet.pop();
+        const uint32_t node = current.second;
+        if (current.first > gScore[node])
+        {
+            // Stale heap item, the node was already reached at a lower cost
+            continue;
+        }
+
+        if (!fixed[node])
+        {
+            const RoutingTableEntry* firstHopEntry = Lookup(graph.GetAddress(firstHop[node]));
+            if (firstHopEntry == nullptr)
             {
-                Vector lastPos = GetNodePosition(topology_tuple.lastAddr);
-                Vector destPos = GetNodePosition(topology_tuple.destAddr);
-                
-                double distance = CalculateDistance(lastPos, destPos);
-                double cost = gScore[topology_tuple.lastAddr] + distance + 
-                              topology_tuple.helloInterval.GetSeconds();
-
-                if (gScore.find(topology_tuple.destAddr) == gScore.end() ||
-                    cost < gScore[topology_tuple.destAddr])
-                {
-                    gScore[topology_tuple.destAddr] = cost;
-                    cameFrom[topology_tuple.destAddr] = topology_tuple.lastAddr;
-                    AddEntry(topology_tuple.destAddr, lastAddrEntry.nextAddr, 
-                             lastAddrEntry.interface, h + 1);
-                    added = true;
-                }
+                continue;
             }
+            AddEntry(graph.GetAddress(node),
+                     firstHopEntry->nextAddr,
+                     firstHopEntry->interface,
+                     hops[node]);
         }
 
-        if (!added)
+        for (const RouteGraph::Edge& edge : graph.GetEdges(node))
         {
-            break;
+            double cost =
+                gScore[node] + CalculateDistance(positions[node], positions[edge.to]) + edge.cost;
+            if (!fixed[edge.to] && cost < gScore[edge.to])
+            {
+                gScore[edge.to] = cost;
+                hops[edge.to] = hops[node] + 1;
+                firstHop[edge.to] = firstHop[node];
+                openSet.emplace(cost, edge.to);
+            }
         }
     }
 
@@ -1250,11 +1721,8 @@ RoutingProtocol::RoutingTableComputation()
     //   then a new routing entry is created.
     const AssociationSet& associationSet = m_state.GetAssociationSet();
 
-    // Clear HNA routing table
-    for (uint32_t i = 0; i < m_hnaRoutingTable->GetNRoutes(); i++)
-    {
-        m_hnaRoutingTable->RemoveRoute(0);
-    }
+    // The new HNA routing table is built aside, then swapped with the live one
+    m_hnaRoutingTableBuffer.Clear();
 
     for (auto it = associationSet.begin(); it != associationSet.end(); it++)
     {
@@ -1285,48 +1753,70 @@ RoutingProtocol::RoutingTableComputation()
             continue;
         }
 
-        RoutingTableEntry gatewayEntry;
-
-        bool gatewayEntryExists = Lookup(tuple.gatewayAddr, gatewayEntry);
-        bool addRoute = false;
-
-        uint32_t routeIndex = 0;
-
-        for (routeIndex = 0; routeIndex < m_hnaRoutingTable->GetNRoutes(); routeIndex++)
+        const RoutingTableEntry* gatewayEntry = Lookup(tuple.gatewayAddr);
+        if (gatewayEntry == nullptr)
         {
-            Ipv4RoutingTableEntry route = m_hnaRoutingTable->GetRoute(routeIndex);
-            if (route.GetDestNetwork() == tuple.networkAddr &&
-                route.GetDestNetworkMask() == tuple.netmask)
-            {
-                break;
-            }
+            continue;
         }
 
-        if (routeIndex == m_hnaRoutingTable->GetNRoutes())
+        // Keeps the closest gateway of the network
+        const HnaRoute* existing =
+            m_hnaRoutingTableBuffer.FindRoute(tuple.networkAddr, tuple.netmask);
+        if (existing != nullptr && existing->distance <= gatewayEntry->distance)
         {
-            addRoute = true;
+            continue;
         }
-        else if (gatewayEntryExists &&
-                 m_hnaRoutingTable->GetMetric(routeIndex) > gatewayEntry.distance)
+
+        HnaRoute route;
+        route.networkAddr = tuple.networkAddr;
+        route.netmask = tuple.netmask;
+        route.nextAddr = gatewayEntry->nextAddr;
+        route.interface = gatewayEntry->interface;
+        route.distance = gatewayEntry->distance;
+
+        // Reuses the route of the live table when the gateway did not change
+        const HnaRoute* previous = m_hnaRoutingTable.FindRoute(tuple.networkAddr, tuple.netmask);
+        if (previous != nullptr && previous->route && previous->nextAddr == route.nextAddr &&
+            previous->interface == route.interface &&
+            previous->route->GetSource() == gatewayEntry->sourceAddr)
         {
-            m_hnaRoutingTable->RemoveRoute(routeIndex);
-            addRoute = true;
+            route.route = previous->route;
         }
-
-        if (addRoute && gatewayEntryExists)
+        else if (gatewayEntry->sourceAddr.IsInitialized())
         {
-            m_hnaRoutingTable->AddNetworkRouteTo(tuple.networkAddr,
-                                                 tuple.netmask,
-                                                 gatewayEntry.nextAddr,
-                                                 gatewayEntry.interface,
-                                                 gatewayEntry.distance);
+            route.route = Create<Ipv4Route>();
+            route.route->SetDestination(tuple.networkAddr);
+            route.route->SetSource(gatewayEntry->sourceAddr);
+            route.route->SetGateway(gatewayEntry->nextAddr);
+            route.route->SetOutputDevice(m_ipv4->GetNetDevice(gatewayEntry->interface));
         }
+        m_hnaRoutingTableBuffer.AddRoute(route);
     }
+    m_hnaRoutingTable.Swap(m_hnaRoutingTableBuffer);
+
+    // Routes handed out for the previous table are kept only if their entry did not change
+    PruneRouteCache();
 
     NS_LOG_DEBUG("Node " << m_mainAddress << ": RoutingTableComputation end.");
     m_routingTableChanged(GetSize());
 }
 
+void
+RoutingProtocol::RefreshRoutesOnMovement()
+{
+    // The other nodes moved at most at the highest speed they advertised
+    double elapsed = (Simulator::Now() - m_routesTime).GetSeconds();
+    double moved = std::max(CalculateDistance(GetPosition(), m_routesPosition),
+                            m_state.GetMaxNodeSpeed() * elapsed);
+    if (moved > m_routeRefreshDistance)
+    {
+        NS_LOG_DEBUG("Node " << m_mainAddress << ": nodes moved up to " << moved
+                             << " m since the last routing table computation.");
+        m_routingTableDirty = true;
+        RoutingTableComputation();
+    }
+}
+
 void
 RoutingProtocol::ProcessHello(const olsr::MessageHeader& msg,
                               const Ipv4Address& receiverIface,
@@ -1337,6 +1827,9 @@ RoutingProtocol::ProcessHello(const olsr::MessageHeader& msg,
     const olsr::MessageHeader::Hello& hello = msg.GetHello();
 
     LinkSensing(msg, hello, receiverIface, senderIface);
+    ProcessPositionInfo(msg.GetOriginatorAddress(),
+                        hello.positionInfo,
+                        Simulator::Now() + msg.GetVTime());
 
 #ifdef NS3_LOG_ENABLE
     {
@@ -1376,7 +1869,7 @@ RoutingProtocol::ProcessHello(const olsr::MessageHeader& msg,
     }
 #endif // NS3_LOG_ENABLE
 
-    MprComputation();
+    UpdateMprSet();
     PopulateMprSelectorSet(msg, hello);
 }
 
@@ -1394,6 +1887,13 @@ RoutingProtocol::ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& se
         return;
     }
 
+    // (not part of the RFC) differential TC messages are applied to the current topology
+    if (tc.delta)
+    {
+        ProcessTcDelta(msg);
+        return;
+    }
+
     // 2. If there exist some tuple in the topology set where:
     //    T_last_addr == originator address AND
     //    T_seq       >  ANSN,
@@ -1410,50 +1910,22 @@ RoutingProtocol::ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& se
     //    T_last_addr == originator address AND
     //    T_seq       <  ANSN
     // MUST be removed from the topology set.
+    std::size_t topologySize = m_state.GetTopologySet().size();
     m_state.EraseOlderTopologyTuples(msg.GetOriginatorAddress(), tc.ansn);
+    if (m_state.GetTopologySet().size() != topologySize)
+    {
+        m_routingTableDirty = true;
+    }
+
+    // (not part of the RFC) record the position advertised by the originator.
+    ProcessPositionInfo(msg.GetOriginatorAddress(), tc.positionInfo, now + msg.GetVTime());
+    const Vector position = GetNodePosition(msg.GetOriginatorAddress());
 
     // 4. For each of the advertised neighbor main address received in
     // the TC message:
-    for (auto i = tc.neighborAddresses.begin(); i != tc.neighborAddresses.end(); i++)
+    for (const Ipv4Address& addr : tc.neighborAddresses)
     {
-        const Ipv4Address& addr = *i;
-        // 4.1. If there exist some tuple in the topology set where:
-        //      T_dest_addr == advertised neighbor main address, AND
-        //      T_last_addr == originator address,
-        // then the holding time of that tuple MUST be set to:
-        //      T_time      =  current time + validity time.
-        TopologyTuple* topologyTuple = m_state.FindTopologyTuple(addr, msg.GetOriginatorAddress());
-
-        if (topologyTuple != nullptr)
-        {
-            topologyTuple->expirationTime = now + msg.GetVTime();
-            topologyTuple->position = tc.GetPosition();
-            topologyTuple->helloInterval = Seconds(tc.GetHelloInterval());
-        }
-        else
-        {
-            // 4.2. Otherwise, a new tuple MUST be recorded in the topology
-            // set where:
-            //      T_dest_addr = advertised neighbor main address,
-            //      T_last_addr = originator address,
-            //      T_seq       = ANSN,
-            //      T_time      = current time + validity time.
-            TopologyTuple topologyTuple;
-            topologyTuple.destAddr = addr;
-            topologyTuple.lastAddr = msg.GetOriginatorAddress();
-            topologyTuple.sequenceNumber = tc.ansn;
-            topologyTuple.expirationTime = now + msg.GetVTime();
-            topologyTuple.position = tc.GetPosition();
-            topologyTuple.helloInterval = Seconds(tc.GetHelloInterval());
-            AddTopologyTuple(topologyTuple);
-
-            // Schedules topology tuple deletion
-            m_events.Track(Simulator::Schedule(DELAY(topologyTuple.expirationTime),
-                                               &RoutingProtocol::TopologyTupleTimerExpire,
-                                               this,
-                                               topologyTuple.destAddr,
-                                               topologyTuple.lastAddr));
-        }
+        UpdateTopologyTuple(addr, msg, position);
     }
 
 #ifdef NS3_LOG_ENABLE
@@ -1470,6 +1942,117 @@ RoutingProtocol::ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& se
 #endif // NS3_LOG_ENABLE
 }
 
+void
+RoutingProtocol::ProcessTcDelta(const olsr::MessageHeader& msg)
+{
+    const olsr::MessageHeader::Tc& tc = msg.GetTc();
+    const Ipv4Address& originator = msg.GetOriginatorAddress();
+    Time now = Simulator::Now();
+
+    // The changes only apply to the topology advertised with the base ANSN. A single pass
+    // checks it and collects the tuples of the originator
+    std::vector<TopologyTuple*> tuples;
+    for (TopologyTuple& tuple : m_state.GetTopologySet())
+    {
+        if (tuple.lastAddr == originator)
+        {
+            if (tuple.sequenceNumber != tc.baseAnsn)
+            {
+                NS_LOG_DEBUG("Ignoring differential TC from " << originator << " based on ANSN "
+                                                              << tc.baseAnsn);
+                return;
+            }
+            tuples.push_back(&tuple);
+        }
+    }
+    if (tuples.empty())
+    {
+        NS_LOG_DEBUG("Ignoring differential TC from unknown originator " << originator);
+        return;
+    }
+
+    ProcessPositionInfo(originator, tc.positionInfo, now + msg.GetVTime());
+    const Vector position = GetNodePosition(originator);
+
+    // The tuples which are still advertised get the new ANSN, and are refreshed
+    for (TopologyTuple* tuple : tuples)
+    {
+        tuple->sequenceNumber = tc.ansn;
+        tuple->expirationTime = now + msg.GetVTime();
+        if (tuple->helloInterval != tc.GetHelloInterval())
+        {
+            // The route costs depend on these fields
+            m_routingTableDirty = true;
+        }
+        tuple->position = position;
+        tuple->helloInterval = tc.GetHelloInterval();
+    }
+
+    // The collected tuples are not used past this point: erasing and adding tuples moves them
+    if (m_state.EraseTopologyTuples(originator, tc.removedAddresses) > 0)
+    {
+        m_routingTableDirty = true;
+    }
+
+    for (const Ipv4Address& addr : tc.neighborAddresses)
+    {
+        UpdateTopologyTuple(addr, msg, position);
+    }
+}
+
+void
+RoutingProtocol::UpdateTopologyTuple(const Ipv4Address& destAddr,
+                                     const olsr::MessageHeader& msg,
+                                     const Vector& position)
+{
+    const olsr::MessageHeader::Tc& tc = msg.GetTc();
+    Time now = Simulator::Now();
+
+    // 4.1. If there exist some tuple in the topology set where:
+    //      T_dest_addr == advertised neighbor main address, AND
+    //      T_last_addr == originator address,
+    // then the holding time of that tuple MUST be set to:
+    //      T_time      =  current time + validity time.
+    TopologyTuple* topologyTuple = m_state.FindTopologyTuple(destAddr, msg.GetOriginatorAddress());
+
+    if (topologyTuple != nullptr)
+    {
+        topologyTuple->expirationTime = now + msg.GetVTime();
+        if (topologyTuple->helloInterval != tc.GetHelloInterval())
+        {
+            // The route costs depend on these fields
+            m_routingTableDirty = true;
+        }
+        topologyTuple->position = position;
+        topologyTuple->helloInterval = tc.GetHelloInterval();
+    }
+    else
+    {
+        // 4.2. Otherwise, a new tuple MUST be recorded in the topology
+        // set where:
+        //      T_dest_addr = advertised neighbor main address,
+        //      T_last_addr = originator address,
+        //      T_seq       = ANSN,
+        //      T_time      = current time + validity time.
+        TopologyTuple topologyTuple;
+        topologyTuple.destAddr = destAddr;
+        topologyTuple.lastAddr = msg.GetOriginatorAddress();
+        topologyTuple.sequenceNumber = tc.ansn;
+        topologyTuple.expirationTime = now + msg.GetVTime();
+        topologyTuple.position = position;
+        topologyTuple.helloInterval = tc.GetHelloInterval();
+        topologyTuple.generation = ++m_expiryGeneration;
+        AddTopologyTuple(topologyTuple);
+
+        // Schedules topology tuple deletion
+        ScheduleExpiry(topologyTuple.expirationTime,
+                       ExpiryKind::TOPOLOGY,
+                       topologyTuple.generation,
+                       topologyTuple.destAddr,
+                       topologyTuple.lastAddr);
+    }
+}
+
 void
 RoutingProtocol::ProcessMid(const olsr::MessageHeader& msg, const Ipv4Address& senderIface)
 {
@@ -1509,31 +2092,41 @@ RoutingProtocol::ProcessMid(const olsr::MessageHeader& msg, const Ipv4Address& s
             tuple.ifaceAddr = *i;
             tuple.mainAddr = msg.GetOriginatorAddress();
             tuple.time = now + msg.GetVTime();
+            tuple.generation = ++m_expiryGeneration;
             AddIfaceAssocTuple(tuple);
             NS_LOG_LOGIC("New IfaceAssoc added: " << tuple);
             // Schedules iface association tuple deletion
-            Simulator::Schedule(DELAY(tuple.time),
-                                &RoutingProtocol::IfaceAssocTupleTimerExpire,
-                                this,
-                                tuple.ifaceAddr);
+            ScheduleExpiry(tuple.time, ExpiryKind::IFACE_ASSOC, tuple.generation, tuple.ifaceAddr);
         }
     }
 
     // 3. (not part of the RFC) iterate over all NeighborTuple's and
     // TwoHopNeighborTuples, update the neighbor addresses taking into account
     // the new MID information.
+    bool rewritten = false;
     NeighborSet& neighbors = m_state.GetNeighbors();
     for (auto neighbor = neighbors.begin(); neighbor != neighbors.end(); neighbor++)
     {
-        neighbor->neighborMainAddr = GetMainAddress(neighbor->neighborMainAddr);
+        Ipv4Address mainAddr = GetMainAddress(neighbor->neighborMainAddr);
+        rewritten |= (mainAddr != neighbor->neighborMainAddr);
+        neighbor->neighborMainAddr = mainAddr;
     }
 
     TwoHopNeighborSet& twoHopNeighbors = m_state.GetTwoHopNeighbors();
     for (auto twoHopNeighbor = twoHopNeighbors.begin(); twoHopNeighbor != twoHopNeighbors.end();
          twoHopNeighbor++)
     {
-        twoHopNeighbor->neighborMainAddr = GetMainAddress(twoHopNeighbor->neighborMainAddr);
-        twoHopNeighbor->twoHopNeighborAddr = GetMainAddress(twoHopNeighbor->twoHopNeighborAddr);
+        Ipv4Address neighborMainAddr = GetMainAddress(twoHopNeighbor->neighborMainAddr);
+        Ipv4Address twoHopNeighborAddr = GetMainAddress(twoHopNeighbor->twoHopNeighborAddr);
+        rewritten |= (neighborMainAddr != twoHopNeighbor->neighborMainAddr ||
+                      twoHopNeighborAddr != twoHopNeighbor->twoHopNeighborAddr);
+        twoHopNeighbor->neighborMainAddr = neighborMainAddr;
+        twoHopNeighbor->twoHopNeighborAddr = twoHopNeighborAddr;
+    }
+    if (rewritten)
+    {
+        m_state.ReindexNeighbors();
+        m_routingTableDirty = true;
     }
     NS_LOG_DEBUG("Node " << m_mainAddress << " ProcessMid from " << senderIface << " -> END.");
 }
@@ -1581,24 +2174,25 @@ RoutingProtocol::ProcessHna(const olsr::MessageHeader& msg, const Ipv4Address& s
             AssociationTuple assocTuple = {msg.GetOriginatorAddress(),
                                            it->address,
                                            it->mask,
-                                           now + msg.GetVTime()};
+                                           now + msg.GetVTime(),
+                                           ++m_expiryGeneration};
             AddAssociationTuple(assocTuple);
 
             // Schedule Association Tuple deletion
-            Simulator::Schedule(DELAY(assocTuple.expirationTime),
-                                &RoutingProtocol::AssociationTupleTimerExpire,
-                                this,
-                                assocTuple.gatewayAddr,
-                                assocTuple.networkAddr,
-                                assocTuple.netmask);
+            ScheduleExpiry(assocTuple.expirationTime,
+                           ExpiryKind::ASSOCIATION,
+                           assocTuple.generation,
+                           assocTuple.gatewayAddr,
+                           assocTuple.networkAddr,
+                           assocTuple.netmask);
         }
     }
 }
 
 void
-RoutingProtocol::ForwardDefault(olsr::MessageHeader olsrMessage,
-                                DuplicateTuple* duplicated,
-                                const Ipv4Address& localIface,
+RoutingProtocol::ForwardDefault(olsr::MessageView& olsrMessage,
+                                bool duplicated,
+                                uint32_t localIface,
                                 const Ipv4Address& senderAddress)
 {
     Time now = Simulator::Now();
@@ -1613,7 +2207,8 @@ RoutingProtocol::ForwardDefault(olsr::MessageHeader olsrMessage,
 
     // If the message has already been considered for forwarding,
     // it must not be retransmitted again
-    if (duplicated != nullptr && duplicated->retransmitted)
+    if (duplicated && m_state.IsRetransmitted(olsrMessage.GetOriginatorAddress(),
+                                              olsrMessage.GetMessageSequenceNumber()))
     {
         NS_LOG_LOGIC(Simulator::Now()
                      << "Node " << m_mainAddress
@@ -1633,49 +2228,56 @@ RoutingProtocol::ForwardDefault(olsr::MessageHeader olsrMessage,
             m_state.FindMprSelectorTuple(GetMainAddress(senderAddress));
         if (mprselTuple != nullptr)
         {
-            olsrMessage.SetTimeToLive(olsrMessage.GetTimeToLive() - 1);
-            olsrMessage.SetHopCount(olsrMessage.GetHopCount() + 1);
+            olsrMessage.PrepareForward();
             // We have to introduce a random delay to avoid
             // synchronization with neighbors.
-            QueueMessage(olsrMessage, JITTER);
+            QueueMessage(olsrMessage.CreateForwardedMessage(),
+                         MessagePriority::FORWARDED,
+                         JITTER + m_forwardingHoldTime);
             retransmitted = true;
         }
     }
 
-    // Update duplicate tuple...
-    if (duplicated != nullptr)
-    {
-        duplicated->expirationTime = now + OLSR_DUP_HOLD_TIME;
-        duplicated->retransmitted = retransmitted;
-        duplicated->ifaceList.push_back(localIface);
-    }
-    // ...or create a new one
-    else
+    // Update the duplicate tuple, or create a new one
+    if (m_state.InsertDuplicate(olsrMessage.GetOriginatorAddress(),
+                                olsrMessage.GetMessageSequenceNumber(),
+                                localIface,
+                                retransmitted,
+                                now + OLSR_DUP_HOLD_TIME))
     {
-        DuplicateTuple newDup;
-        newDup.address = olsrMessage.GetOriginatorAddress();
-        newDup.sequenceNumber = olsrMessage.GetMessageSequenceNumber();
-        newDup.expirationTime = now + OLSR_DUP_HOLD_TIME;
-        newDup.retransmitted = retransmitted;
-        newDup.ifaceList.push_back(localIface);
-        AddDuplicateTuple(newDup);
-        // Schedule dup tuple deletion
-        Simulator::Schedule(OLSR_DUP_HOLD_TIME,
-                            &RoutingProtocol::DupTupleTimerExpire,
-                            this,
-                            newDup.address,
-                            newDup.sequenceNumber);
+        // Schedule the deletion of the originator's duplicate window
+        ScheduleExpiry(now + OLSR_DUP_HOLD_TIME,
+                       ExpiryKind::DUPLICATE,
+                       0,
+                       olsrMessage.GetOriginatorAddress());
     }
 }
 
 void
 RoutingProtocol::QueueMessage(const olsr::MessageHeader& message, Time delay)
 {
-    m_queuedMessages.push_back(message);
-    if (not m_queuedMessagesTimer.IsRunning())
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(message);
+    QueueMessage(packet,
+                 message.GetMessageType() == olsr::MessageHeader::HELLO_MESSAGE
+                     ? MessagePriority::HELLO
+                     : MessagePriority::OWN,
+                 delay);
+}
+
+void
+RoutingProtocol::QueueMessage(Ptr<Packet> message, MessagePriority priority, Time delay)
+{
+    m_queuedMessages.push_back({message, priority});
+
+    // A message due before the pending ones brings them forward
+    Time deadline = Simulator::Now() + delay;
+    if (not m_queuedMessagesTimer.IsRunning() || deadline < m_queuedMessagesDeadline)
     {
+        m_queuedMessagesTimer.Cancel();
         m_queuedMessagesTimer.SetDelay(delay);
         m_queuedMessagesTimer.Schedule();
+        m_queuedMessagesDeadline = deadline;
     }
 }
 
@@ -1693,44 +2295,66 @@ RoutingProtocol::SendPacket(Ptr<Packet> packet, const MessageList& containedMess
     // Trace it
     m_txPacketTrace(header, containedMessages);
 
-    // Send it
-    for (auto i = m_sendSockets.begin(); i != m_sendSockets.end(); i++)
+    // Send it. The packet is serialized once: the copies share its buffer, copy-on-write, and
+    // the last interface sends the packet itself
+    for (uint32_t i = 0; i < m_broadcastDestinations.size(); i++)
     {
-        Ptr<Packet> pkt = packet->Copy();
-        Ipv4Address bcast = i->second.GetLocal().GetSubnetDirectedBroadcast(i->second.GetMask());
-        i->first->SendTo(pkt, 0, InetSocketAddress(bcast, OLSR_PORT_NUMBER));
+        Ptr<Packet> pkt = (i + 1 < m_broadcastDestinations.size()) ? packet->Copy() : packet;
+        m_broadcastDestinations[i].first->SendTo(pkt, 0, m_broadcastDestinations[i].second);
     }
 }
 
 void
 RoutingProtocol::SendQueuedMessages()
 {
-    Ptr<Packet> packet = Create<Packet>();
-    int numMessages = 0;
-
     NS_LOG_DEBUG("Olsr node " << m_mainAddress << ": SendQueuedMessages");
 
-    MessageList msglist;
+    // The packet header is added by SendPacket
+    const uint32_t headerSize = olsr::PacketHeader().GetSerializedSize();
 
-    for (auto message = m_queuedMessages.begin(); message != m_queuedMessages.end(); message++)
+    // Higher priority messages go first, so they make it into the first packet
+    std::stable_sort(m_queuedMessages.begin(),
+                     m_queuedMessages.end(),
+                     [](const QueuedMessage& a, const QueuedMessage& b) {
+                         return a.priority < b.priority;
+                     });
+
+    auto first = m_queuedMessages.begin();
+    while (first != m_queuedMessages.end())
     {
-        Ptr<Packet> p = Create<Packet>();
-        p->AddHeader(*message);
-        packet->AddAtEnd(p);
-        msglist.push_back(*message);
-        if (++numMessages == OLSR_MAX_MSGS)
+        // Pack as many messages as fit in the MTU
+        uint32_t size = first->message->GetSize();
+        auto last = first + 1;
+        while (last != m_queuedMessages.end() && last - first < OLSR_MAX_MSGS &&
+               headerSize + size + last->message->GetSize() <= m_maxPacketSize)
         {
-            SendPacket(packet, msglist);
-            msglist.clear();
-            // Reset variables for next packet
-            numMessages = 0;
-            packet = Create<Packet>();
+            size += last->message->GetSize();
+            last++;
+        }
+        if (headerSize + size > m_maxPacketSize)
+        {
+            NS_LOG_WARN("OLSR message of " << size << " bytes does not fit the MTU");
         }
-    }
 
-    if (packet->GetSize())
-    {
+        // Chain the serialized messages, whose bytes the packet shares copy-on-write
+        Ptr<Packet> packet = Create<Packet>();
+        MessageList msglist;
+        for (auto queued = first; queued != last; queued++)
+        {
+            packet->AddAtEnd(queued->message);
+            // The messages are only decoded again for the trace sinks, if any
+            if (!m_txPacketTrace.IsEmpty())
+            {
+                msglist.emplace_back();
+                queued->message->PeekHeader(msglist.back());
+            }
+        }
+
+        m_packetsSent++;
+        m_packedBytes += headerSize + size;
+        m_packetPackingTrace(headerSize + size, m_maxPacketSize);
         SendPacket(packet, msglist);
+        first = last;
     }
 
     m_queuedMessages.clear();
@@ -1753,6 +2377,7 @@ RoutingProtocol::SendHello()
 
     hello.SetHTime(m_helloInterval);
     hello.willingness = m_willingness;
+    FillPositionInfo(hello.positionInfo, m_helloMotion);
 
     std::vector<olsr::MessageHeader::Hello::LinkMessage>& linkMessages = hello.linkMessages;
 
@@ -1851,33 +2476,135 @@ RoutingProtocol::SendTc()
 {
     NS_LOG_FUNCTION(this);
 
-    Ptr<MobilityModel> mobility = m_ipv4->GetObject<MobilityModel>();
-    Vector currentPosition;
-    if (mobility)
+    olsr::MessageHeader msg;
+
+    std::vector<Ipv4Address> advertised = GetAdvertisedNeighbors();
+    if (advertised.empty())
     {
-        currentPosition= mobility->GetPosition();
+        NS_LOG_DEBUG("Not sending any TC, no neighbors to advertise.");
+        // The receivers drop the topology, so the next TC message must be a full one
+        m_lastTcTtl = 0;
+        return;
     }
 
-    olsr::MessageHeader msg;
+    // The topology tuples must outlive the wait for the next TC message reaching as far
+    uint32_t period;
+    uint8_t ttl = GetNextTcTtl(period);
 
-    msg.SetVTime(OLSR_TOP_HOLD_TIME);
+    msg.SetVTime(period * OLSR_TOP_HOLD_TIME);
     msg.SetOriginatorAddress(m_mainAddress);
-    msg.SetTimeToLive(255);
+    msg.SetTimeToLive(ttl);
     msg.SetHopCount(0);
     msg.SetMessageSequenceNumber(GetMessageSequenceNumber());
 
     olsr::MessageHeader::Tc& tc = msg.GetTc();
+    FillTcNeighbors(tc, std::move(advertised), ttl);
+    FillPositionInfo(tc.positionInfo, m_tcMotion);
+    tc.SetHelloInterval(m_helloInterval);
+
+    QueueMessage(msg, JITTER);
+}
+
+void
+RoutingProtocol::FillTcNeighbors(olsr::MessageHeader::Tc& tc,
+                                 std::vector<Ipv4Address> advertised,
+                                 uint8_t ttl)
+{
+    std::sort(advertised.begin(), advertised.end());
+
+    // The receivers only drop the neighbors no longer advertised when the ANSN is a new one,
+    // whatever made the advertised set change
+    if (advertised != m_lastTcNeighbors && m_ansn == m_lastTcAnsn)
+    {
+        IncrementAnsn();
+    }
     tc.ansn = m_ansn;
-    tc.SetPosition(currentPosition);
-    tc.SetHelloInterval(m_helloInterval.GetSeconds());
 
-    for (auto mprsel_tuple = m_state.GetMprSelectors().begin();
-         mprsel_tuple != m_state.GetMprSelectors().end();
-         mprsel_tuple++)
+    // With DifferentialTc, the changes can only be sent to the nodes reached by the previous TC
+    // message, and when they are shorter than the whole list
+    if (m_differentialTc && m_lastTcTtl >= ttl && m_tcsSinceFullRefresh + 1 < m_tcFullRefreshPeriod)
     {
-        tc.neighborAddresses.push_back(mprsel_tuple->mainAddr);
+        std::set_difference(advertised.begin(),
+                            advertised.end(),
+                            m_lastTcNeighbors.begin(),
+                            m_lastTcNeighbors.end(),
+                            std::back_inserter(tc.neighborAddresses));
+        std::set_difference(m_lastTcNeighbors.begin(),
+                            m_lastTcNeighbors.end(),
+                            advertised.begin(),
+                            advertised.end(),
+                            std::back_inserter(tc.removedAddresses));
+        // The base ANSN and the number of added neighbors take one more address worth of bytes
+        tc.delta = tc.neighborAddresses.size() + tc.removedAddresses.size() + 1 < advertised.size();
+    }
+
+    if (tc.delta)
+    {
+        tc.baseAnsn = m_lastTcAnsn;
+        m_tcsSinceFullRefresh++;
     }
-    QueueMessage(msg, JITTER);
+    else
+    {
+        tc.neighborAddresses = advertised;
+        tc.removedAddresses.clear();
+        m_tcsSinceFullRefresh = 0;
+    }
+    m_lastTcNeighbors = std::move(advertised);
+    m_lastTcAnsn = m_ansn;
+    m_lastTcTtl = ttl;
+}
+
+std::vector<Ipv4Address>
+RoutingProtocol::GetAdvertisedNeighbors() const
+{
+    std::vector<Ipv4Address> advertised;
+    if (m_tcRedundancy == ALL_NEIGHBORS)
+    {
+        for (const NeighborTuple& neighbor : m_state.GetNeighbors())
+        {
+            if (neighbor.status == NeighborTuple::STATUS_SYM)
+            {
+                advertised.push_back(neighbor.neighborMainAddr);
+            }
+        }
+        return advertised;
+    }
+
+    for (const MprSelectorTuple& mprSelector : m_state.GetMprSelectors())
+    {
+        advertised.push_back(mprSelector.mainAddr);
+    }
+    if (m_tcRedundancy == MPR_SELECTORS_AND_MPRS)
+    {
+        for (const Ipv4Address& mpr : m_state.GetMprSet())
+        {
+            if (std::find(advertised.begin(), advertised.end(), mpr) == advertised.end())
+            {
+                advertised.push_back(mpr);
+            }
+        }
+    }
+    return advertised;
+}
+
+uint8_t
+RoutingProtocol::GetNextTcTtl(uint32_t& period)
+{
+    period = 1;
+    if (m_fisheyeTtls.empty())
+    {
+        return 255;
+    }
+
+    uint32_t index = m_fisheyeIndex;
+    m_fisheyeIndex = (m_fisheyeIndex + 1) % m_fisheyeTtls.size();
+    uint8_t ttl = m_fisheyeTtls[index];
+    while (period < m_fisheyeTtls.size() &&
+           m_fisheyeTtls[(index + period) % m_fisheyeTtls.size()] < ttl)
+    {
+        period++;
+    }
+    return ttl;
 }
 
 void
@@ -1978,6 +2705,7 @@ RoutingProtocol::AddHostNetworkAssociation(Ipv4Address networkAddr, Ipv4Mask net
     // If the tuple does not already exist, add it to the list of local HNA associations.
     NS_LOG_INFO("Adding HNA association for network " << networkAddr << "/" << netmask << ".");
     m_state.InsertAssociation((Association){networkAddr, netmask});
+    m_routingTableDirty = true;
 }
 
 void
@@ -1985,6 +2713,7 @@ RoutingProtocol::RemoveHostNetworkAssociation(Ipv4Address networkAddr, Ipv4Mask
 {
     NS_LOG_INFO("Removing HNA association for network " << networkAddr << "/" << netmask << ".");
     m_state.EraseAssociation((Association){networkAddr, netmask});
+    m_routingTableDirty = true;
 }
 
 void
@@ -2066,6 +2795,7 @@ RoutingProtocol::LinkSensing(const olsr::MessageHeader& msg,
         newLinkTuple.localIfaceAddr = receiverIface;
         newLinkTuple.symTime = now - Seconds(1);
         newLinkTuple.time = now + msg.GetVTime();
+        newLinkTuple.generation = ++m_expiryGeneration;
         link_tuple = &m_state.InsertLinkTuple(newLinkTuple);
         created = true;
         NS_LOG_LOGIC("Existing link tuple did not exist => creating new one");
@@ -2143,10 +2873,10 @@ RoutingProtocol::LinkSensing(const olsr::MessageHeader& msg,
     if (created)
     {
         LinkTupleAdded(*link_tuple, hello.willingness);
-        m_events.Track(Simulator::Schedule(DELAY(std::min(link_tuple->time, link_tuple->symTime)),
-                                           &RoutingProtocol::LinkTupleTimerExpire,
-                                           this,
-                                           link_tuple->neighborIfaceAddr));
+        ScheduleExpiry(std::min(link_tuple->time, link_tuple->symTime),
+                       ExpiryKind::LINK,
+                       link_tuple->generation,
+                       link_tuple->neighborIfaceAddr);
     }
     NS_LOG_DEBUG("@" << now.As(Time::S) << ": Olsr node " << m_mainAddress << ": LinkSensing END");
 }
@@ -2158,6 +2888,10 @@ RoutingProtocol::PopulateNeighborSet(const olsr::MessageHeader& msg,
     NeighborTuple* nb_tuple = m_state.FindNeighborTuple(msg.GetOriginatorAddress());
     if (nb_tuple != nullptr)
     {
+        if (nb_tuple->willingness != hello.willingness)
+        {
+            m_mprSetDirty = true;
+        }
         nb_tuple->willingness = hello.willingness;
     }
 }
@@ -2229,13 +2963,14 @@ RoutingProtocol::PopulateTwoHopNeighborSet(const olsr::MessageHeader& msg,
                         new_nb2hop_tuple.neighborMainAddr = msg.GetOriginatorAddress();
                         new_nb2hop_tuple.twoHopNeighborAddr = nb2hop_addr;
                         new_nb2hop_tuple.expirationTime = now + msg.GetVTime();
+                        new_nb2hop_tuple.generation = ++m_expiryGeneration;
                         AddTwoHopNeighborTuple(new_nb2hop_tuple);
                         // Schedules nb2hop tuple deletion
-                        m_events.Track(Simulator::Schedule(DELAY(new_nb2hop_tuple.expirationTime),
-                                                           &RoutingProtocol::Nb2hopTupleTimerExpire,
-                                                           this,
-                                                           new_nb2hop_tuple.neighborMainAddr,
-                                                           new_nb2hop_tuple.twoHopNeighborAddr));
+                        ScheduleExpiry(new_nb2hop_tuple.expirationTime,
+                                       ExpiryKind::TWO_HOP,
+                                       new_nb2hop_tuple.generation,
+                                       new_nb2hop_tuple.neighborMainAddr,
+                                       new_nb2hop_tuple.twoHopNeighborAddr);
                     }
                     else
                     {
@@ -2251,7 +2986,12 @@ RoutingProtocol::PopulateTwoHopNeighborSet(const olsr::MessageHeader& msg,
                     // 2-hop neighbor are deleted.
                     NS_LOG_LOGIC(
                         "2-hop neighbor is NOT_NEIGH => deleting matching 2-hop neighbor state");
+                    std::size_t twoHopSize = m_state.GetTwoHopNeighbors().size();
                     m_state.EraseTwoHopNeighborTuples(msg.GetOriginatorAddress(), nb2hop_addr);
+                    if (m_state.GetTwoHopNeighbors().size() != twoHopSize)
+                    {
+                        m_routingTableDirty = true;
+                    }
                 }
                 else
                 {
@@ -2300,13 +3040,14 @@ RoutingProtocol::PopulateMprSelectorSet(const olsr::MessageHeader& msg,
 
                         mprsel_tuple.mainAddr = msg.GetOriginatorAddress();
                         mprsel_tuple.expirationTime = now + msg.GetVTime();
+                        mprsel_tuple.generation = ++m_expiryGeneration;
                         AddMprSelectorTuple(mprsel_tuple);
 
                         // Schedules mpr selector tuple deletion
-                        m_events.Track(Simulator::Schedule(DELAY(mprsel_tuple.expirationTime),
-                                                           &RoutingProtocol::MprSelTupleTimerExpire,
-                                                           this,
-                                                           mprsel_tuple.mainAddr));
+                        ScheduleExpiry(mprsel_tuple.expirationTime,
+                                       ExpiryKind::MPR_SELECTOR,
+                                       mprsel_tuple.generation,
+                                       mprsel_tuple.mainAddr);
                     }
                     else
                     {
@@ -2366,32 +3107,17 @@ RoutingProtocol::NeighborLoss(const LinkTuple& tuple)
     m_state.EraseTwoHopNeighborTuples(GetMainAddress(tuple.neighborIfaceAddr));
     m_state.EraseMprSelectorTuples(GetMainAddress(tuple.neighborIfaceAddr));
 
-    MprComputation();
+    m_routingTableDirty = true;
+    if (m_expirySweep)
+    {
+        // Recomputed once at the end of the expiry sweep
+        m_expiryLosses++;
+        return;
+    }
+    UpdateMprSet();
     RoutingTableComputation();
 }
 
-void
-RoutingProtocol::AddDuplicateTuple(const DuplicateTuple& tuple)
-{
-    /*debug("%f: Node %d adds dup tuple: addr = %d seq_num = %d\n",
-            Simulator::Now (),
-            OLSR::node_id(ra_addr()),
-            OLSR::node_id(tuple->addr()),
-            tuple->seq_num());*/
-    m_state.InsertDuplicateTuple(tuple);
-}
-
-void
-RoutingProtocol::RemoveDuplicateTuple(const DuplicateTuple& tuple)
-{
-    /*debug("%f: Node %d removes dup tuple: addr = %d seq_num = %d\n",
-      Simulator::Now (),
-      OLSR::node_id(ra_addr()),
-      OLSR::node_id(tuple->addr()),
-      tuple->seq_num());*/
-    m_state.EraseDuplicateTuple(tuple);
-}
-
 void
 RoutingProtocol::LinkTupleAdded(const LinkTuple& tuple, Willingness willingness)
 {
@@ -2420,6 +3146,7 @@ RoutingProtocol::RemoveLinkTuple(const LinkTuple& tuple)
 
     m_state.EraseNeighborTuple(GetMainAddress(tuple.neighborIfaceAddr));
     m_state.EraseLinkTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 void
@@ -2468,6 +3195,11 @@ RoutingProtocol::LinkTupleUpdated(const LinkTuple& tuple, Willingness willingnes
             NS_LOG_DEBUG(*nb_tuple << "->status = STATUS_NOT_SYM; changed:"
                                    << int(statusBefore != nb_tuple->status));
         }
+        if (statusBefore != nb_tuple->status)
+        {
+            m_routingTableDirty = true;
+            m_mprSetDirty = true;
+        }
     }
     else
     {
@@ -2485,6 +3217,8 @@ RoutingProtocol::AddNeighborTuple(const NeighborTuple& tuple)
     //         ((tuple->status() == OLSR_STATUS_SYM) ? "sym" : "not_sym"));
 
     m_state.InsertNeighborTuple(tuple);
+    m_routingTableDirty = true;
+    m_mprSetDirty = true;
     IncrementAnsn();
 }
 
@@ -2498,6 +3232,7 @@ RoutingProtocol::RemoveNeighborTuple(const NeighborTuple& tuple)
     //         ((tuple->status() == OLSR_STATUS_SYM) ? "sym" : "not_sym"));
 
     m_state.EraseNeighborTuple(tuple);
+    m_routingTableDirty = true;
     IncrementAnsn();
 }
 
@@ -2511,6 +3246,7 @@ RoutingProtocol::AddTwoHopNeighborTuple(const TwoHopNeighborTuple& tuple)
     //         OLSR::node_id(tuple->twoHopNeighborAddr));
 
     m_state.InsertTwoHopNeighborTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 void
@@ -2523,6 +3259,7 @@ RoutingProtocol::RemoveTwoHopNeighborTuple(const TwoHopNeighborTuple& tuple)
     //         OLSR::node_id(tuple->twoHopNeighborAddr));
 
     m_state.EraseTwoHopNeighborTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 void
@@ -2566,6 +3303,7 @@ RoutingProtocol::AddTopologyTuple(const TopologyTuple& tuple)
     //         tuple->seq());
 
     m_state.InsertTopologyTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 void
@@ -2579,6 +3317,7 @@ RoutingProtocol::RemoveTopologyTuple(const TopologyTuple& tuple)
     //         tuple->seq());
 
     m_state.EraseTopologyTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 void
@@ -2591,6 +3330,7 @@ RoutingProtocol::AddIfaceAssocTuple(const IfaceAssocTuple& tuple)
     //         OLSR::node_id(tuple->iface_addr()));
 
     m_state.InsertIfaceAssocTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 void
@@ -2603,18 +3343,21 @@ RoutingProtocol::RemoveIfaceAssocTuple(const IfaceAssocTuple& tuple)
     //         OLSR::node_id(tuple->iface_addr()));
 
     m_state.EraseIfaceAssocTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 void
 RoutingProtocol::AddAssociationTuple(const AssociationTuple& tuple)
 {
     m_state.InsertAssociationTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 void
 RoutingProtocol::RemoveAssociationTuple(const AssociationTuple& tuple)
 {
     m_state.EraseAssociationTuple(tuple);
+    m_routingTableDirty = true;
 }
 
 uint16_t
@@ -2636,20 +3379,18 @@ RoutingProtocol::HelloTimerExpire()
 {
     SendHello();
     CalculateSpeed(); // TC에도 넣으면 빈도가 너무 많아짐, Hello만 해도 파악이 충분히 가능함
+    RefreshRoutesOnMovement();
+    if (m_adaptiveTimers)
+    {
+        AdjustTimers();
+    }
     m_helloTimer.Schedule(m_helloInterval);
 }
 
 void
 RoutingProtocol::TcTimerExpire()
 {
-    if (!m_state.GetMprSelectors().empty())
-    {
-        SendTc();
-    }
-    else
-    {
-        NS_LOG_DEBUG("Not sending any TC, no one selected me as MPR.");
-    }
+    SendTc();
     m_tcTimer.Schedule(m_tcInterval);
 }
 
@@ -2675,24 +3416,200 @@ RoutingProtocol::HnaTimerExpire()
 }
 
 void
-RoutingProtocol::DupTupleTimerExpire(Ipv4Address address, uint16_t sequenceNumber)
+RoutingProtocol::ScheduleExpiry(Time deadline,
+                                ExpiryKind kind,
+                                uint32_t generation,
+                                Ipv4Address first,
+                                Ipv4Address second,
+                                Ipv4Mask mask)
 {
-    DuplicateTuple* tuple = m_state.FindDuplicateTuple(address, sequenceNumber);
-    if (tuple == nullptr)
+    m_expiryQueue.push({deadline, m_expiryOrder++, kind, generation, first, second, mask});
+    if (m_expiryQueue.size() >= m_expiryCompactSize)
+    {
+        CompactExpiryQueue();
+    }
+    m_expiryQueueSize = m_expiryQueue.size();
+
+    // The sweep re-arms the timer itself once done
+    if (m_expirySweep)
     {
         return;
     }
-    if (tuple->expirationTime < Simulator::Now())
+    Time delay = DELAY(deadline);
+    if (m_expiryTimer.IsRunning() && m_expiryTimer.GetDelayLeft() <= delay)
+    {
+        return;
+    }
+    m_expiryTimer.Cancel();
+    m_expiryTimer.Schedule(delay);
+}
+
+namespace
+{
+/**
+ * \brief Tests whether a tuple is missing, or is another tuple than the one of an expiry entry.
+ * \param tuple The tuple with the key of the expiry entry, if any.
+ * \param generation The generation of the expiry entry.
+ * \returns true if the tuple of the expiry entry was removed.
+ */
+template <typename Tuple>
+bool
+IsOtherTuple(const Tuple* tuple, uint32_t generation)
+{
+    return tuple == nullptr || tuple->generation != generation;
+}
+} // unnamed namespace
+
+bool
+RoutingProtocol::IsExpiryEntryStale(const ExpiryEntry& entry)
+{
+    switch (entry.kind)
+    {
+    case ExpiryKind::DUPLICATE:
+        return m_state.FindDuplicateWindow(entry.first) == nullptr;
+    case ExpiryKind::LINK:
+        return IsOtherTuple(m_state.FindLinkTuple(entry.first), entry.generation);
+    case ExpiryKind::TWO_HOP:
+        return IsOtherTuple(m_state.FindTwoHopNeighborTuple(entry.first, entry.second),
+                            entry.generation);
+    case ExpiryKind::MPR_SELECTOR:
+        return IsOtherTuple(m_state.FindMprSelectorTuple(entry.first), entry.generation);
+    case ExpiryKind::TOPOLOGY:
+        return IsOtherTuple(m_state.FindTopologyTuple(entry.first, entry.second),
+                            entry.generation);
+    case ExpiryKind::NODE_POSITION:
+        return m_state.FindNodePosition(entry.first) < 0;
+    case ExpiryKind::IFACE_ASSOC:
+        return IsOtherTuple(m_state.FindIfaceAssocTuple(entry.first), entry.generation);
+    case ExpiryKind::ASSOCIATION:
+        return IsOtherTuple(m_state.FindAssociationTuple(entry.first, entry.second, entry.mask),
+                            entry.generation);
+    }
+    return true;
+}
+
+void
+RoutingProtocol::CompactExpiryQueue()
+{
+    std::vector<ExpiryEntry> live;
+    live.reserve(m_expiryQueue.size());
+    while (!m_expiryQueue.empty())
+    {
+        if (!IsExpiryEntryStale(m_expiryQueue.top()))
+        {
+            live.push_back(m_expiryQueue.top());
+        }
+        m_expiryQueue.pop();
+    }
+    NS_LOG_LOGIC("Node " << m_mainAddress << ": expiry queue compacted to " << live.size()
+                         << " entries.");
+
+    // The entries come out sorted, so pushing them back in order is linear
+    for (const auto& entry : live)
+    {
+        m_expiryQueue.push(entry);
+    }
+    m_expiryCompactSize =
+        std::max<uint32_t>(OLSR_EXPIRY_COMPACT_MIN_SIZE, 2 * m_expiryQueue.size());
+}
+
+void
+RoutingProtocol::ExpiryTimerExpire()
+{
+    Time now = Simulator::Now();
+
+    m_expirySweep = true;
+    while (!m_expiryQueue.empty() && m_expiryQueue.top().deadline < now)
+    {
+        ExpiryEntry entry = m_expiryQueue.top();
+        m_expiryQueue.pop();
+
+        // The tuple may have been removed and added again, with an entry of its own
+        if (IsExpiryEntryStale(entry))
+        {
+            continue;
+        }
+
+        switch (entry.kind)
+        {
+        case ExpiryKind::DUPLICATE:
+            DupTupleTimerExpire(entry.first);
+            break;
+        case ExpiryKind::LINK:
+            LinkTupleTimerExpire(entry.first);
+            break;
+        case ExpiryKind::TWO_HOP:
+            Nb2hopTupleTimerExpire(entry.first, entry.second);
+            break;
+        case ExpiryKind::MPR_SELECTOR:
+            MprSelTupleTimerExpire(entry.first);
+            break;
+        case ExpiryKind::TOPOLOGY:
+            TopologyTupleTimerExpire(entry.first, entry.second);
+            break;
+        case ExpiryKind::NODE_POSITION:
+            NodePositionTimerExpire(entry.first);
+            break;
+        case ExpiryKind::IFACE_ASSOC:
+            IfaceAssocTupleTimerExpire(entry.first);
+            break;
+        case ExpiryKind::ASSOCIATION:
+            AssociationTupleTimerExpire(entry.first, entry.second, entry.mask);
+            break;
+        }
+    }
+    m_expirySweep = false;
+    m_expiryQueueSize = m_expiryQueue.size();
+
+    if (!m_expiryQueue.empty())
+    {
+        m_expiryTimer.Schedule(DELAY(m_expiryQueue.top().deadline));
+    }
+
+    if (m_expiryLosses > 0 && !m_lossTimer.IsRunning())
+    {
+        if (m_expiryCoalescingWindow.IsZero())
+        {
+            LossTimerExpire();
+        }
+        else
+        {
+            // The losses detected until the timer fires share its computation
+            m_lossTimer.Schedule(m_expiryCoalescingWindow);
+        }
+    }
+}
+
+void
+RoutingProtocol::LossTimerExpire()
+{
+    if (m_expiryLosses > 1)
+    {
+        NS_LOG_DEBUG("Node " << m_mainAddress << ": " << m_expiryLosses
+                             << " neighbor losses handled by a single computation.");
+        m_coalescedRecomputations += m_expiryLosses - 1;
+        m_recomputationsSavedTrace(m_expiryLosses - 1);
+    }
+    m_expiryLosses = 0;
+    UpdateMprSet();
+    RoutingTableComputation();
+}
+
+void
+RoutingProtocol::DupTupleTimerExpire(Ipv4Address address)
+{
+    const DuplicateWindow* window = m_state.FindDuplicateWindow(address);
+    if (window == nullptr)
+    {
+        return;
+    }
+    if (window->expirationTime < Simulator::Now())
     {
-        RemoveDuplicateTuple(*tuple);
+        m_state.EraseDuplicateWindow(address);
     }
     else
     {
-        m_events.Track(Simulator::Schedule(DELAY(tuple->expirationTime),
-                                           &RoutingProtocol::DupTupleTimerExpire,
-                                           this,
-                                           address,
-                                           sequenceNumber));
+        ScheduleExpiry(window->expirationTime, ExpiryKind::DUPLICATE, 0, address);
     }
 }
 
@@ -2722,17 +3639,14 @@ RoutingProtocol::LinkTupleTimerExpire(Ipv4Address neighborIfaceAddr)
             NeighborLoss(*tuple);
         }
 
-        m_events.Track(Simulator::Schedule(DELAY(tuple->time),
-                                           &RoutingProtocol::LinkTupleTimerExpire,
-                                           this,
-                                           neighborIfaceAddr));
+        ScheduleExpiry(tuple->time, ExpiryKind::LINK, tuple->generation, neighborIfaceAddr);
     }
     else
     {
-        m_events.Track(Simulator::Schedule(DELAY(std::min(tuple->time, tuple->symTime)),
-                                           &RoutingProtocol::LinkTupleTimerExpire,
-                                           this,
-                                           neighborIfaceAddr));
+        ScheduleExpiry(std::min(tuple->time, tuple->symTime),
+                       ExpiryKind::LINK,
+                       tuple->generation,
+                       neighborIfaceAddr);
     }
 }
 
@@ -2752,11 +3666,11 @@ RoutingProtocol::Nb2hopTupleTimerExpire(Ipv4Address neighborMainAddr,
     }
     else
     {
-        m_events.Track(Simulator::Schedule(DELAY(tuple->expirationTime),
-                                           &RoutingProtocol::Nb2hopTupleTimerExpire,
-                                           this,
-                                           neighborMainAddr,
-                                           twoHopNeighborAddr));
+        ScheduleExpiry(tuple->expirationTime,
+                       ExpiryKind::TWO_HOP,
+                       tuple->generation,
+                       neighborMainAddr,
+                       twoHopNeighborAddr);
     }
 }
 
@@ -2774,10 +3688,10 @@ RoutingProtocol::MprSelTupleTimerExpire(Ipv4Address mainAddr)
     }
     else
     {
-        m_events.Track(Simulator::Schedule(DELAY(tuple->expirationTime),
-                                           &RoutingProtocol::MprSelTupleTimerExpire,
-                                           this,
-                                           mainAddr));
+        ScheduleExpiry(tuple->expirationTime,
+                       ExpiryKind::MPR_SELECTOR,
+                       tuple->generation,
+                       mainAddr);
     }
 }
 
@@ -2795,11 +3709,33 @@ RoutingProtocol::TopologyTupleTimerExpire(Ipv4Address destAddr, Ipv4Address last
     }
     else
     {
-        m_events.Track(Simulator::Schedule(DELAY(tuple->expirationTime),
-                                           &RoutingProtocol::TopologyTupleTimerExpire,
-                                           this,
-                                           tuple->destAddr,
-                                           tuple->lastAddr));
+        ScheduleExpiry(tuple->expirationTime,
+                       ExpiryKind::TOPOLOGY,
+                       tuple->generation,
+                       tuple->destAddr,
+                       tuple->lastAddr);
+    }
+}
+
+void
+RoutingProtocol::NodePositionTimerExpire(Ipv4Address mainAddr)
+{
+    int32_t index = m_state.FindNodePosition(mainAddr);
+    if (index < 0)
+    {
+        return;
+    }
+    if (m_state.GetNodePositionExpirationTime(index) < Simulator::Now())
+    {
+        m_state.EraseNodePosition(mainAddr);
+        m_routingTableDirty = true;
+    }
+    else
+    {
+        ScheduleExpiry(m_state.GetNodePositionExpirationTime(index),
+                       ExpiryKind::NODE_POSITION,
+                       0,
+                       mainAddr);
     }
 }
 
@@ -2817,10 +3753,7 @@ RoutingProtocol::IfaceAssocTupleTimerExpire(Ipv4Address ifaceAddr)
     }
     else
     {
-        m_events.Track(Simulator::Schedule(DELAY(tuple->time),
-                                           &RoutingProtocol::IfaceAssocTupleTimerExpire,
-                                           this,
-                                           ifaceAddr));
+        ScheduleExpiry(tuple->time, ExpiryKind::IFACE_ASSOC, tuple->generation, ifaceAddr);
     }
 }
 
@@ -2840,12 +3773,12 @@ RoutingProtocol::AssociationTupleTimerExpire(Ipv4Address gatewayAddr,
     }
     else
     {
-        m_events.Track(Simulator::Schedule(DELAY(tuple->expirationTime),
-                                           &RoutingProtocol::AssociationTupleTimerExpire,
-                                           this,
-                                           gatewayAddr,
-                                           networkAddr,
-                                           netmask));
+        ScheduleExpiry(tuple->expirationTime,
+                       ExpiryKind::ASSOCIATION,
+                       tuple->generation,
+                       gatewayAddr,
+                       networkAddr,
+                       netmask);
     }
 }
 
@@ -2853,41 +3786,99 @@ void
 RoutingProtocol::Clear()
 {
     NS_LOG_FUNCTION_NOARGS();
+    // Keeps the capacity, the table is refilled right away by RoutingTableComputation
     m_table.clear();
+    m_tableIndex.clear();
 }
 
 void
 RoutingProtocol::RemoveEntry(const Ipv4Address& dest)
 {
-    m_table.erase(dest);
+    auto it = m_tableIndex.find(dest);
+    if (it == m_tableIndex.end())
+    {
+        return;
+    }
+    m_routeCache.erase(dest);
+    uint32_t index = it->second;
+    m_tableIndex.erase(it);
+
+    // Moves the last entry into the freed slot
+    if (index != m_table.size() - 1)
+    {
+        m_table[index] = m_table.back();
+        m_tableIndex[m_table[index].destAddr] = index;
+    }
+    m_table.pop_back();
 }
 
-bool
-RoutingProtocol::Lookup(const Ipv4Address& dest, RoutingTableEntry& outEntry) const
+const RoutingTableEntry*
+RoutingProtocol::Lookup(const Ipv4Address& dest) const
 {
-    // Get the iterator at "dest" position
-    auto it = m_table.find(dest);
-    // If there is no route to "dest", return NULL
-    if (it == m_table.end())
+    auto it = m_tableIndex.find(dest);
+    if (it == m_tableIndex.end())
     {
-        return false;
+        return nullptr;
     }
-    outEntry = it->second;
-    return true;
+    return &m_table[it->second];
+}
+
+Ptr<Ipv4Route>
+RoutingProtocol::GetRoute(const RoutingTableEntry& entry)
+{
+    CachedRoute& cached = m_routeCache[entry.destAddr];
+    if (cached.route && IsCachedRouteValid(cached, entry))
+    {
+        return cached.route;
+    }
+
+    if (!entry.sourceAddr.IsInitialized())
+    {
+        /// \todo Implement IP aliasing and OLSR
+        NS_FATAL_ERROR("XXX Not implemented yet:  IP aliasing and OLSR");
+    }
+    cached.route = Create<Ipv4Route>();
+    cached.route->SetDestination(entry.destAddr);
+    cached.route->SetSource(entry.sourceAddr);
+    cached.route->SetGateway(entry.nextAddr);
+    cached.route->SetOutputDevice(m_ipv4->GetNetDevice(entry.interface));
+    cached.interface = entry.interface;
+    return cached.route;
+}
+
+Ptr<Ipv4Route>
+RoutingProtocol::GetRoute(const HnaRoute& route) const
+{
+    if (!route.route)
+    {
+        /// \todo Implement IP aliasing and OLSR
+        NS_FATAL_ERROR("XXX Not implemented yet:  IP aliasing and OLSR");
+    }
+    return route.route;
 }
 
 bool
-RoutingProtocol::FindSendEntry(const RoutingTableEntry& entry, RoutingTableEntry& outEntry) const
+RoutingProtocol::IsCachedRouteValid(const CachedRoute& cached, const RoutingTableEntry& entry)
+{
+    return cached.interface == entry.interface && cached.route->GetGateway() == entry.nextAddr &&
+           cached.route->GetSource() == entry.sourceAddr;
+}
+
+void
+RoutingProtocol::PruneRouteCache()
 {
-    outEntry = entry;
-    while (outEntry.destAddr != outEntry.nextAddr)
+    for (auto it = m_routeCache.begin(); it != m_routeCache.end();)
     {
-        if (not Lookup(outEntry.nextAddr, outEntry))
+        const RoutingTableEntry* entry = Lookup(it->first);
+        if (entry == nullptr || !it->second.route || !IsCachedRouteValid(it->second, *entry))
         {
-            return false;
+            it = m_routeCache.erase(it);
+        }
+        else
+        {
+            it++;
         }
     }
-    return true;
 }
 
 Ptr<Ipv4Route>
@@ -2899,18 +3890,13 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
     NS_LOG_FUNCTION(this << " " << m_ipv4->GetObject<Node>()->GetId() << " "
                          << header.GetDestination() << " " << oif);
     Ptr<Ipv4Route> rtentry;
-    RoutingTableEntry entry1;
-    RoutingTableEntry entry2;
     bool found = false;
 
-    if (Lookup(header.GetDestination(), entry1)) // 목적지에 대한 라우팅 테이블 엔트리를 검색, 성공시 True 반환 및 entry1에 검색된 엔트리 저장
+    // 목적지에 대한 라우팅 테이블 엔트리를 검색, next hop은 이미 이웃으로 해석되어 있음
+    const RoutingTableEntry* entry = Lookup(header.GetDestination());
+    if (entry != nullptr)
     {
-        bool foundSendEntry = FindSendEntry(entry1, entry2);
-        if (!foundSendEntry)
-        {
-            NS_FATAL_ERROR("FindSendEntry failure");
-        }
-        uint32_t interfaceIdx = entry2.interface;
+        uint32_t interfaceIdx = entry->interface;
         if (oif && m_ipv4->GetInterfaceForDevice(oif) != static_cast<int>(interfaceIdx))
         {
             // We do not attempt to perform a constrained routing search
@@ -2924,31 +3910,11 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
             sockerr = Socket::ERROR_NOROUTETOHOST;
             return rtentry;
         }
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(header.GetDestination());
-        // the source address is the interface address that matches
-        // the destination address (when multiple are present on the
-        // outgoing interface, one is selected via scoping rules)
-        NS_ASSERT(m_ipv4);
-        uint32_t numOifAddresses = m_ipv4->GetNAddresses(interfaceIdx);
-        NS_ASSERT(numOifAddresses > 0);
-        Ipv4InterfaceAddress ifAddr;
-        if (numOifAddresses == 1)
-        {
-            ifAddr = m_ipv4->GetAddress(interfaceIdx, 0);
-        }
-        else
-        {
-            /// \todo Implement IP aliasing and OLSR
-            NS_FATAL_ERROR("XXX Not implemented yet:  IP aliasing and OLSR");
-        }
-        rtentry->SetSource(ifAddr.GetLocal());
-        rtentry->SetGateway(entry2.nextAddr);
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        rtentry = GetRoute(*entry);
         sockerr = Socket::ERROR_NOTERROR;
         NS_LOG_DEBUG("Olsr node " << m_mainAddress << ": RouteOutput for dest="
-                                  << header.GetDestination() << " --> nextHop=" << entry2.nextAddr
-                                  << " interface=" << entry2.interface);
+                                  << header.GetDestination() << " --> nextHop=" << entry->nextAddr
+                                  << " interface=" << entry->interface);
         NS_LOG_DEBUG("Found route to " << rtentry->GetDestination() << " via nh "
                                        << rtentry->GetGateway() << " with source addr "
                                        << rtentry->GetSource() << " and output dev "
@@ -2957,10 +3923,13 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
     }
     else
     {
-        rtentry = m_hnaRoutingTable->RouteOutput(p, header, oif, sockerr);
-
-        if (rtentry)
+        // As above, the HNA route must use the requested outbound interface
+        const HnaRoute* hnaRoute = m_hnaRoutingTable.Lookup(header.GetDestination());
+        if (hnaRoute != nullptr &&
+            (!oif || m_ipv4->GetInterfaceForDevice(oif) == static_cast<int>(hnaRoute->interface)))
         {
+            rtentry = GetRoute(*hnaRoute);
+            sockerr = Socket::ERROR_NOTERROR;
             found = true;
             NS_LOG_DEBUG("Found route to " << rtentry->GetDestination() << " via nh "
                                            << rtentry->GetGateway() << " with source addr "
@@ -3024,42 +3993,14 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
 
     NS_LOG_LOGIC("Forward packet");
     // Forwarding
-    Ptr<Ipv4Route> rtentry;
-    RoutingTableEntry entry1;
-    RoutingTableEntry entry2;
-    if (Lookup(header.GetDestination(), entry1))
+    const RoutingTableEntry* entry = Lookup(header.GetDestination());
+    if (entry != nullptr)
     {
-        bool foundSendEntry = FindSendEntry(entry1, entry2);
-        if (!foundSendEntry)
-        {
-            NS_FATAL_ERROR("FindSendEntry failure");
-        }
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(header.GetDestination());
-        uint32_t interfaceIdx = entry2.interface;
-        // the source address is the interface address that matches
-        // the destination address (when multiple are present on the
-        // outgoing interface, one is selected via scoping rules)
-        NS_ASSERT(m_ipv4);
-        uint32_t numOifAddresses = m_ipv4->GetNAddresses(interfaceIdx);
-        NS_ASSERT(numOifAddresses > 0);
-        Ipv4InterfaceAddress ifAddr;
-        if (numOifAddresses == 1)
-        {
-            ifAddr = m_ipv4->GetAddress(interfaceIdx, 0);
-        }
-        else
-        {
-            /// \todo Implement IP aliasing and OLSR
-            NS_FATAL_ERROR("XXX Not implemented yet:  IP aliasing and OLSR");
-        }
-        rtentry->SetSource(ifAddr.GetLocal());
-        rtentry->SetGateway(entry2.nextAddr);
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        Ptr<Ipv4Route> rtentry = GetRoute(*entry);
 
         NS_LOG_DEBUG("Olsr node " << m_mainAddress << ": RouteInput for dest="
-                                  << header.GetDestination() << " --> nextHop=" << entry2.nextAddr
-                                  << " interface=" << entry2.interface);
+                                  << header.GetDestination() << " --> nextHop=" << entry->nextAddr
+                                  << " interface=" << entry->interface);
 
         ucb(rtentry, p, header);
         return true;
@@ -3067,8 +4008,13 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
     else
     {
         NS_LOG_LOGIC("No dynamic route, check network routes");
-        if (m_hnaRoutingTable->RouteInput(p, header, idev, ucb, mcb, lcb, ecb))
+        const HnaRoute* hnaRoute = m_hnaRoutingTable.Lookup(dst);
+        if (hnaRoute != nullptr)
         {
+            NS_LOG_LOGIC("Forward to network " << hnaRoute->networkAddr << "/"
+                                               << hnaRoute->netmask << " via "
+                                               << hnaRoute->nextAddr);
+            ucb(GetRoute(*hnaRoute), p, header);
             return true;
         }
         else
@@ -3078,10 +4024,10 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
                                       << ": RouteInput for dest=" << header.GetDestination()
                                       << " --> NOT FOUND; ** Dumping routing table...");
 
-            for (auto iter = m_table.begin(); iter != m_table.end(); iter++)
+            for (const RoutingTableEntry& entry : m_table)
             {
-                NS_LOG_DEBUG("dest=" << iter->first << " --> next=" << iter->second.nextAddr
-                                     << " via interface " << iter->second.interface);
+                NS_LOG_DEBUG("dest=" << entry.destAddr << " --> next=" << entry.nextAddr
+                                     << " via interface " << entry.interface);
             }
 
             NS_LOG_DEBUG("** Routing table dump end.");
@@ -3122,13 +4068,41 @@ RoutingProtocol::AddEntry(const Ipv4Address& dest,
 
     NS_ASSERT(distance > 0);
 
+    // Resolves the next hop to a neighbor before the table is modified, since the arguments
+    // may refer to one of its entries
+    Ipv4Address nextAddr = next;
+    if (next != dest)
+    {
+        const RoutingTableEntry* nextEntry = Lookup(next);
+        if (nextEntry != nullptr)
+        {
+            nextAddr = nextEntry->nextAddr;
+            interface = nextEntry->interface;
+        }
+    }
+
     // Creates a new rt entry with specified values
-    RoutingTableEntry& entry = m_table[dest];
+    auto it = m_tableIndex.find(dest);
+    if (it == m_tableIndex.end())
+    {
+        it = m_tableIndex.emplace(dest, m_table.size()).first;
+        m_table.emplace_back();
+    }
+    RoutingTableEntry& entry = m_table[it->second];
 
     entry.destAddr = dest;
-    entry.nextAddr = next;
+    entry.nextAddr = nextAddr;
     entry.interface = interface;
     entry.distance = distance;
+
+    // the source address is the interface address that matches
+    // the destination address (when multiple are present on the
+    // outgoing interface, one is selected via scoping rules)
+    entry.sourceAddr = Ipv4Address();
+    if (m_ipv4 && m_ipv4->GetNAddresses(interface) == 1)
+    {
+        entry.sourceAddr = m_ipv4->GetAddress(interface, 0).GetLocal();
+    }
 }
 
 void
@@ -3162,11 +4136,12 @@ RoutingProtocol::AddEntry(const Ipv4Address& dest,
 std::vector<RoutingTableEntry>
 RoutingProtocol::GetRoutingTableEntries() const
 {
-    std::vector<RoutingTableEntry> retval;
-    for (auto iter = m_table.begin(); iter != m_table.end(); iter++)
-    {
-        retval.push_back(iter->second);
-    }
+    std::vector<RoutingTableEntry> retval(m_table);
+    std::sort(retval.begin(),
+              retval.end(),
+              [](const RoutingTableEntry& a, const RoutingTableEntry& b) {
+                  return a.destAddr < b.destAddr;
+              });
     return retval;
 }
 
@@ -3176,6 +4151,28 @@ RoutingProtocol::GetMprSet() const
     return m_state.GetMprSet();
 }
 
+uint32_t
+RoutingProtocol::GetSkippedMprComputations() const
+{
+    return m_skippedMprComputations;
+}
+
+uint32_t
+RoutingProtocol::GetCoalescedRecomputations() const
+{
+    return m_coalescedRecomputations;
+}
+
+double
+RoutingProtocol::GetPackingEfficiency() const
+{
+    if (m_packetsSent == 0)
+    {
+        return 0;
+    }
+    return double(m_packedBytes) / (double(m_packetsSent) * m_maxPacketSize);
+}
+
 const MprSelectorSet&
 RoutingProtocol::GetMprSelectors() const
 {
@@ -3250,16 +4247,16 @@ RoutingProtocol::Dump()
         }
     }
     NS_LOG_DEBUG(" Routing table");
-    for (auto iter = m_table.begin(); iter != m_table.end(); iter++)
+    for (const RoutingTableEntry& entry : m_table)
     {
-        NS_LOG_DEBUG("  dest=" << iter->first << " --> next=" << iter->second.nextAddr
-                               << " via interface " << iter->second.interface);
+        NS_LOG_DEBUG("  dest=" << entry.destAddr << " --> next=" << entry.nextAddr
+                               << " via interface " << entry.interface);
     }
     NS_LOG_DEBUG("");
 #endif // NS3_LOG_ENABLE
 }
 
-Ptr<const Ipv4StaticRouting>
+const HnaRoutingTable&
 RoutingProtocol::GetRoutingTableAssociation() const
 {
     return m_hnaRoutingTable;
@@ -23,10 +23,11 @@
 #define OLSR_AGENT_IMPL_H
 
 #include "olsr-header.h"
+#include "olsr-hna-routing-table.h"
 #include "olsr-repositories.h"
 #include "olsr-state.h"
 
-#include "ns3/event-garbage-collector.h"
+#include "ns3/inet-socket-address.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-static-routing.h"
 #include "ns3/ipv4.h"
@@ -38,13 +39,34 @@
 #include "ns3/test.h"
 #include "ns3/timer.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/vector.h"
 
 #include <map>
+#include <queue>
+#include <unordered_map>
 #include <vector>
 
 /// Testcase for MPR computation mechanism
 class OlsrMprTestCase;
+/// Testcase for the routing table
+class OlsrRoutingTableTestCase;
+/// Testcase for the TC advertised neighbors and scope
+class OlsrTcScopeTestCase;
+/// Testcase for the differential TC messages
+class OlsrDifferentialTcTestCase;
+/// Testcase for the coalescing of the neighbor losses
+class OlsrExpiryCoalescingTestCase;
+/// Testcase for the expiry entries of the tuples added again under the same key
+class OlsrExpiryGenerationTestCase;
+/// Testcase for the priorities of the outgoing message queue
+class OlsrMessageQueueTestCase;
+/// Testcase for the packing of the queued messages into packets
+class OlsrPacketPackingTestCase;
+/// Testcase for the advertisement and extrapolation of the node positions
+class OlsrPositionTestCase;
+/// Testcase for the recomputation of the routing table as the nodes move
+class OlsrRouteRefreshTestCase;
 
 namespace ns3
 {
@@ -60,10 +82,11 @@ namespace olsr
 /// An OLSR's routing table entry.
 struct RoutingTableEntry
 {
-    Ipv4Address destAddr; //!< Address of the destination node.
-    Ipv4Address nextAddr; //!< Address of the next hop.
-    uint32_t interface;   //!< Interface index
-    uint32_t distance;    //!< Distance in hops to the destination.
+    Ipv4Address destAddr;   //!< Address of the destination node.
+    Ipv4Address nextAddr;   //!< Address of the next hop, always a neighbor.
+    Ipv4Address sourceAddr; //!< Source address of the outgoing interface.
+    uint32_t interface;     //!< Interface index
+    uint32_t distance;      //!< Distance in hops to the destination.
     Vector position;
     Time helloInterval;
 
@@ -71,6 +94,7 @@ struct RoutingTableEntry
         : // default values
           destAddr(),
           nextAddr(),
+          sourceAddr(),
           interface(0),
           distance(0),
           position(Vector(0, 0, 0)),
@@ -93,9 +117,26 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * Declared friend to enable unit tests.
      */
     friend class ::OlsrMprTestCase;
+    friend class ::OlsrRoutingTableTestCase;
+    friend class ::OlsrTcScopeTestCase;
+    friend class ::OlsrDifferentialTcTestCase;
+    friend class ::OlsrExpiryCoalescingTestCase;
+    friend class ::OlsrExpiryGenerationTestCase;
+    friend class ::OlsrMessageQueueTestCase;
+    friend class ::OlsrPacketPackingTestCase;
+    friend class ::OlsrPositionTestCase;
+    friend class ::OlsrRouteRefreshTestCase;
 
     static const uint16_t OLSR_PORT_NUMBER; //!< port number (698)
 
+    /// Neighbors advertised in TC messages, as the TC_REDUNDANCY parameter of \RFC{3626}.
+    enum TcRedundancy : uint8_t
+    {
+        MPR_SELECTORS = 0,          //!< The MPR selectors only.
+        MPR_SELECTORS_AND_MPRS = 1, //!< The MPR selectors and the MPRs.
+        ALL_NEIGHBORS = 2,          //!< All the symmetric neighbors.
+    };
+
     /**
      * \brief Get the type ID.
      * \return The object TypeId.
@@ -131,6 +172,26 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     MprSet GetMprSet() const;
 
+    /**
+     * Gets the number of MPR computations skipped because the neighborhood did not change.
+     * \return The number of skipped MPR computations.
+     */
+    uint32_t GetSkippedMprComputations() const;
+
+    /**
+     * Gets the number of MPR and routing table computations saved by handling the neighbor
+     * losses of an expiry sweep together.
+     * \return The number of saved computations.
+     */
+    uint32_t GetCoalescedRecomputations() const;
+
+    /**
+     * Gets how full the sent %OLSR packets were on average, relative to the largest packet
+     * fitting the MTU of the interfaces.
+     * \return The mean packing efficiency, between 0 and 1.
+     */
+    double GetPackingEfficiency() const;
+
     /**
      * Gets the MPR selectors.
      * \returns The MPR selectors.
@@ -187,18 +248,49 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     typedef void (*TableChangeTracedCallback)(uint32_t size);
 
+    /**
+     * TracedCallback signature for the expiry sweeps that coalesced several neighbor losses.
+     *
+     * \param [in] saved Number of MPR and routing table computations saved by the sweep.
+     */
+    typedef void (*CoalescedRecomputationsTracedCallback)(uint32_t saved);
+
+    /**
+     * TracedCallback signature for the packing of queued messages into a packet.
+     *
+     * \param [in] size Size of the %OLSR packet.
+     * \param [in] maxSize Largest %OLSR packet fitting the MTU of the interfaces.
+     */
+    typedef void (*PacketPackingTracedCallback)(uint32_t size, uint32_t maxSize);
+
+    /**
+     * \brief Updates the node speed, measured over at least two seconds.
+     */
     void CalculateSpeed();
+    /**
+     * \brief Moves the node to the speed band of its current speed, and re-arms
+     * the HELLO and TC timers with the intervals of that band.
+     */
     void AdjustTimers();
 
     /**
      * \brief 특정 IP 주소를 가진 노드의 위치를 업데이트합니다.
      * \param addr 노드의 IP 주소
      * \param position 노드의 새 위치
+     * \param velocity 노드의 속도
+     * \param updateTime 위치를 측정한 시간
+     * \param expirationTime 위치 정보의 만료 시간
      */
-    void UpdateNodePosition(const Ipv4Address& addr, const Vector& position);
+    void UpdateNodePosition(const Ipv4Address& addr,
+                            const Vector& position,
+                            const Vector& velocity,
+                            Time updateTime,
+                            Time expirationTime);
 
     /**
      * \brief 특정 IP 주소를 가진 노드의 위치를 반환합니다.
+     *
+     * The position is extrapolated from the last advertised position and velocity.
      * \param addr 노드의 IP 주소
      * \return 노드의 위치
      */
@@ -210,6 +302,12 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     Vector GetPosition() const;
 
+    /**
+     * \brief Returns the velocity of the current node.
+     * \return The velocity of the current node.
+     */
+    Vector GetVelocity() const;
+
   private:
     std::set<uint32_t> m_interfaceExclusions; //!< Set of interfaces excluded by OSLR.
     Ptr<Ipv4StaticRouting>
@@ -218,6 +316,18 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     Vector m_lastPosition;
     Time m_lastPositionTime;
     double m_speed;
+
+    /// Speed bands of the adaptive HELLO and TC intervals.
+    enum class SpeedBand : uint8_t
+    {
+        LOW,    //!< Below the low speed threshold.
+        MEDIUM, //!< Between the speed thresholds.
+        HIGH,   //!< Above the high speed threshold.
+    };
+
+    bool m_adaptiveTimers;    //!< Adapt the HELLO and TC intervals to the node speed.
+    SpeedBand m_speedBand;    //!< Current speed band.
+    double m_speedHysteresis; //!< Speed margin before falling back to a slower band.
     double m_lowSpeedThreshold;
     double m_highSpeedThreshold;
     Time m_lowSpeedHelloInterval;
@@ -227,9 +337,48 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     Time m_mediumSpeedTcInterval;
     Time m_highSpeedTcInterval;
     Vector m_position;
+    Vector m_positionOrigin;     //!< Origin of the encoded HELLO/TC positions.
+    double m_positionResolution; //!< Resolution of the encoded HELLO/TC positions, in meters.
+
+    /// Position and velocity last advertised in a message type.
+    struct AdvertisedMotion
+    {
+        Vector position;    //!< Advertised position, as decoded by the receivers.
+        Vector velocity;    //!< Advertised velocity, as decoded by the receivers.
+        Time time;          //!< Sampling time of the advertised position.
+        bool valid = false; //!< Whether anything was advertised yet.
+    };
+
+    double m_deadReckoningThreshold;     //!< Maximum dead reckoning error, 0 to disable.
+    Time m_deadReckoningRefreshInterval; //!< Maximum time between two position updates.
+    AdvertisedMotion m_helloMotion;      //!< Motion last advertised in HELLO messages.
+    AdvertisedMotion m_tcMotion;         //!< Motion last advertised in TC messages.
+
+    /**
+     * \brief Fills the position of an outgoing HELLO or TC message.
+     *
+     * When dead reckoning is enabled, the position is left out as long as the
+     * receivers can extrapolate it from the last advertisement within the threshold.
+     *
+     * \param positionInfo The position info of the message.
+     * \param advertised The motion last advertised in messages of the same type.
+     */
+    void FillPositionInfo(olsr::MessageHeader::PositionInfo& positionInfo,
+                          AdvertisedMotion& advertised);
+
+    /**
+     * \brief Records the position of an incoming HELLO or TC message.
+     *
+     * A message without a position extends the validity of the known one.
+     *
+     * \param originator The originator of the message.
+     * \param positionInfo The position info of the message.
+     * \param expirationTime The time the position expires.
+     */
+    void ProcessPositionInfo(const Ipv4Address& originator,
+                             const olsr::MessageHeader::PositionInfo& positionInfo,
+                             Time expirationTime);
 
-    std::map<Ipv4Address, Vector> m_nodePositions;
-    
     /**
      * \brief 두 위치 간의 유클리드 거리를 계산합니다.
      * \param pos1 첫 번째 위치
@@ -237,6 +386,32 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \return 두 위치 간의 거리
      */
     double CalculateDistance(const Vector& pos1, const Vector& pos2);
+
+    /**
+     * \brief Finds the speed band of a speed, with hysteresis.
+     * \param speed The node speed, in m/s.
+     * \param current The current speed band.
+     * \return The new speed band.
+     */
+    SpeedBand ClassifySpeed(double speed, SpeedBand current) const;
+
+    /**
+     * \brief Switches to the HELLO and TC intervals of a speed band.
+     * \param band The speed band.
+     */
+    void ApplySpeedBand(SpeedBand band);
+
+    /**
+     * \brief Re-arms a running periodic timer with a new interval.
+     *
+     * The next expiry is one new interval after the previous one, or immediately
+     * if that time has already passed.
+     *
+     * \param timer The timer.
+     * \param oldInterval The interval the timer was scheduled with.
+     * \param newInterval The new interval.
+     */
+    void RearmTimer(Timer& timer, Time oldInterval, Time newInterval);
     
   public:
     /**
@@ -290,18 +465,29 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \brief Returns the internal HNA table
      * \returns the internal HNA table
      */
-    Ptr<const Ipv4StaticRouting> GetRoutingTableAssociation() const;
+    const HnaRoutingTable& GetRoutingTableAssociation() const;
 
   protected:
     void DoInitialize() override;
     void DoDispose() override;
 
   private:
-    std::map<Ipv4Address, RoutingTableEntry> m_table; //!< Data structure for the routing table.
+    std::vector<RoutingTableEntry> m_table; //!< Routing table entries, in no particular order.
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>
+        m_tableIndex; //!< Position of the routing table entries, by destination address.
+
+    /// A route handed out to the data plane, reused while its routing table entry is unchanged.
+    struct CachedRoute
+    {
+        Ptr<Ipv4Route> route; //!< The route.
+        uint32_t interface;   //!< Interface index of the route.
+    };
 
-    Ptr<Ipv4StaticRouting> m_hnaRoutingTable; //!< Routing table for HNA routes
+    std::unordered_map<Ipv4Address, CachedRoute, Ipv4AddressHash>
+        m_routeCache; //!< Routes handed out to the data plane, by destination address.
 
-    EventGarbageCollector m_events; //!< Running events.
+    HnaRoutingTable m_hnaRoutingTable;       //!< Routing table for HNA routes
+    HnaRoutingTable m_hnaRoutingTableBuffer; //!< HNA routing table being rebuilt
 
     uint16_t m_packetSequenceNumber;  //!< Packets sequence number counter.
     uint16_t m_messageSequenceNumber; //!< Messages sequence number counter.
@@ -313,6 +499,18 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     Time m_hnaInterval;        //!< HNA messages' emission interval.
     Willingness m_willingness; //!< Willingness for forwarding packets on behalf of other nodes.
 
+    TcRedundancy m_tcRedundancy;        //!< Neighbors advertised in TC messages.
+    std::string m_fisheyeTtlList;       //!< TC TTLs cycled through, as set by the attribute.
+    std::vector<uint8_t> m_fisheyeTtls; //!< TC TTLs cycled through, empty for always 255.
+    uint32_t m_fisheyeIndex;            //!< Index of the TTL of the next TC message.
+
+    bool m_differentialTc;                      //!< Send differential TC messages.
+    uint32_t m_tcFullRefreshPeriod;             //!< One TC message out of this many is full.
+    uint32_t m_tcsSinceFullRefresh;             //!< TC messages sent since the last full one.
+    std::vector<Ipv4Address> m_lastTcNeighbors; //!< Neighbors of the last TC message, sorted.
+    uint16_t m_lastTcAnsn;                      //!< ANSN of the last TC message.
+    uint8_t m_lastTcTtl;                        //!< TTL of the last TC message, 0 if none.
+
     OlsrState m_state; //!< Internal state with all needed data structs.
     Ptr<Ipv4> m_ipv4;  //!< IPv4 object the routing is linked to.
 
@@ -338,7 +536,11 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     /**
      * \brief Adds a new entry into the routing table.
      *
-     * If an entry for the given destination existed, it is deleted and freed.
+     * If an entry for the given destination existed, it is overwritten.
+     *
+     * The next hop is resolved when the entry is added: if it is not a neighbor, the next hop
+     * and interface of its own entry are used instead. The source address of the interface is
+     * resolved as well, so that forwarding a packet takes a single lookup.
      *
      * \param dest address of the destination node.
      * \param next address of the next hop node.
@@ -366,31 +568,44 @@ class RoutingProtocol : public Ipv4RoutingProtocol
 
     /**
      * \brief Looks up an entry for the specified destination address.
+     *
+     * The entry is valid until the routing table is modified.
+     *
      * \param [in] dest Destination address.
-     * \param [out] outEntry Holds the routing entry result, if found.
-     * \return true if found, false if not found.
+     * \return The routing entry, or nullptr if not found.
      */
-    bool Lookup(const Ipv4Address& dest, RoutingTableEntry& outEntry) const;
+    const RoutingTableEntry* Lookup(const Ipv4Address& dest) const;
 
     /**
-     * \brief Finds the appropriate entry which must be used in order to forward
-     * a data packet to a next hop (given a destination).
-     *
-     * Imagine a routing table like this: [A,B] [B,C] [C,C]; being each pair of the
-     * form [dest addr, next-hop addr]. In this case, if this function is invoked
-     * with [A,B] then pair [C,C] is returned because C is the next hop that must be used
-     * to forward a data packet destined to A. That is, C is a neighbor of this node,
-     * but B isn't. This function finds the appropriate neighbor for forwarding a packet.
+     * \brief Gets the route to a destination from its routing table entry.
      *
-     * \param[in] entry The routing table entry which indicates the destination node
-     * we are interested in.
+     * Routes are cached by destination and handed out again as long as the routing table
+     * entry they were built from does not change, so that forwarding does not allocate.
      *
-     * \param[out] outEntry The appropriate routing table entry which indicates the next
-     * hop which must be used for forwarding a data packet, or NULL if there is no such entry.
-     *
-     * \return True if an entry was found, false otherwise.
+     * \param entry The routing table entry of the destination.
+     * \return The route.
      */
-    bool FindSendEntry(const RoutingTableEntry& entry, RoutingTableEntry& outEntry) const;
+    Ptr<Ipv4Route> GetRoute(const RoutingTableEntry& entry);
+
+    /**
+     * \brief Gets the route to a destination from its HNA route.
+     * \param route The HNA route of the destination.
+     * \return The route.
+     */
+    Ptr<Ipv4Route> GetRoute(const HnaRoute& route) const;
+
+    /**
+     * \brief Tests whether a cached route still matches a routing table entry.
+     * \param cached The cached route.
+     * \param entry The routing table entry of the same destination.
+     * \return true if the cached route can be handed out for the entry.
+     */
+    static bool IsCachedRouteValid(const CachedRoute& cached, const RoutingTableEntry& entry);
+
+    /**
+     * \brief Drops the cached routes whose routing table entry changed or disappeared.
+     */
+    void PruneRouteCache();
 
   public:
     // From Ipv4RoutingProtocol
@@ -446,11 +661,37 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void MprComputation();
 
+    /**
+     * \brief Computes the MPR set if the neighborhood changed since the last computation.
+     */
+    void UpdateMprSet();
+
+    bool m_mprSetDirty;                //!< Flag to indicate that a neighbor status or willingness
+                                       //!< changed since the last MprComputation.
+    uint32_t m_mprNeighborhoodVersion; //!< Neighborhood version the MPR set was computed for.
+    uint32_t m_skippedMprComputations; //!< Number of MPR computations skipped.
+
     /**
      * \brief Creates the routing table of the node following \RFC{3626} hints.
      */
     void RoutingTableComputation();
 
+    bool m_routingTableDirty; //!< Flag to indicate that the tuples the routing table is computed
+                              //!< from have changed since the last RoutingTableComputation.
+
+    /**
+     * \brief Recomputes the routing table once the nodes may have moved by more than
+     * RouteRefreshDistance since its last computation.
+     *
+     * The route costs depend on the position of this node and on the positions extrapolated
+     * for the other nodes, which change over time even when no tuple does.
+     */
+    void RefreshRoutesOnMovement();
+
+    double m_routeRefreshDistance; //!< Movement triggering a routing table computation.
+    Vector m_routesPosition;       //!< Position of this node in the last computation.
+    Time m_routesTime;             //!< Time of the last routing table computation.
+
   public:
     /**
      * \brief Gets the main address associated with a given interface address.
@@ -495,15 +736,118 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void HnaTimerExpire();
 
+    /// Kinds of tuples whose expiration is handled by the expiry queue.
+    enum class ExpiryKind : uint8_t
+    {
+        DUPLICATE,     //!< Duplicate window, keyed by originator.
+        LINK,          //!< Link tuple, keyed by neighbor interface address.
+        TWO_HOP,       //!< 2-hop neighbor tuple, keyed by neighbor and 2-hop neighbor.
+        MPR_SELECTOR,  //!< MPR selector tuple, keyed by main address.
+        TOPOLOGY,      //!< Topology tuple, keyed by destination and last address.
+        NODE_POSITION, //!< Node position, keyed by main address.
+        IFACE_ASSOC,   //!< Interface association tuple, keyed by interface address.
+        ASSOCIATION,   //!< Association tuple, keyed by gateway, network and netmask.
+    };
+
+    /// A pending tuple expiration.
+    struct ExpiryEntry
+    {
+        Time deadline;       //!< Time at which the tuple must be checked.
+        uint64_t order;      //!< Insertion order, to expire equal deadlines in FIFO order.
+        ExpiryKind kind;     //!< Kind of the tuple.
+        uint32_t generation; //!< Generation of the tuple, 0 for the kinds never re-added.
+        Ipv4Address first;   //!< First key of the tuple.
+        Ipv4Address second;  //!< Second key of the tuple, if any.
+        Ipv4Mask mask;       //!< Netmask of an association tuple.
+
+        /**
+         * \brief Orders the entries by deadline, then by insertion order.
+         * \param other The entry to compare with.
+         * \returns true if this entry expires after the other one.
+         */
+        bool operator>(const ExpiryEntry& other) const
+        {
+            return deadline > other.deadline ||
+                   (deadline == other.deadline && order > other.order);
+        }
+    };
+
+    /// Pending tuple expirations, earliest deadline first.
+    std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<ExpiryEntry>>
+        m_expiryQueue;
+    uint64_t m_expiryOrder;                  //!< Insertion counter of the expiry queue.
+    uint32_t m_expiryGeneration;             //!< Generation of the last tuple added.
+    uint32_t m_expiryCompactSize;            //!< Queue size triggering the next compaction.
+    TracedValue<uint32_t> m_expiryQueueSize; //!< Number of pending tuple expirations.
+    Timer m_expiryTimer;                     //!< Timer for the earliest deadline of the queue.
+    Time m_expiryCoalescingWindow;           //!< Delay gathering close neighbor losses.
+    bool m_expirySweep;                      //!< Whether the expiry queue is being processed.
+    uint32_t m_expiryLosses;                 //!< Neighbor losses not computed yet.
+    Timer m_lossTimer;                       //!< Timer for the computation after a loss.
+    uint32_t m_coalescedRecomputations;      //!< Computations saved by the expiry sweeps.
+
+    /**
+     * \brief Queues the expiration check of a tuple.
+     *
+     * All the tuple expirations of the protocol share a single simulator event, armed
+     * for the earliest deadline of the queue.
+     *
+     * A tuple removed while its expiry entry is pending may be added again under the same
+     * key, with a new entry. The generation of the tuple tells the new entry from the old
+     * one, which is then stale. Duplicate windows and node positions are only removed by
+     * their own entry, so their generation is always 0.
+     *
+     * \param deadline The time at which the tuple must be checked.
+     * \param kind The kind of the tuple.
+     * \param generation The generation of the tuple.
+     * \param first The first key of the tuple.
+     * \param second The second key of the tuple, if any.
+     * \param mask The netmask of an association tuple.
+     */
+    void ScheduleExpiry(Time deadline,
+                        ExpiryKind kind,
+                        uint32_t generation,
+                        Ipv4Address first,
+                        Ipv4Address second = Ipv4Address(),
+                        Ipv4Mask mask = Ipv4Mask());
+
     /**
-     * \brief Removes tuple if expired. Else timer is rescheduled to expire at tuple.expirationTime.
+     * \brief Tests whether the tuple of an expiry entry is gone from the state.
+     * \param entry The expiry entry.
+     * \returns true if the tuple was already removed, even if added again since.
+     */
+    bool IsExpiryEntryStale(const ExpiryEntry& entry);
+
+    /**
+     * \brief Drops the entries of the expiry queue whose tuple was already removed.
      *
-     * The task of actually removing the tuple is left to the OLSR agent.
+     * Tuples erased in bulk (e.g., on a neighbor loss or a MID update) leave their entries
+     * behind until their deadline. The queue is compacted each time it doubles in size, so
+     * that it stays proportional to the number of live tuples.
+     */
+    void CompactExpiryQueue();
+
+    /**
+     * \brief Checks all the tuples whose deadline has passed and re-arms the expiry timer.
+     *
+     * The tuples are checked on time. Neighbor losses detected during the sweep trigger an
+     * MPR and routing table computation, ExpiryCoalescingWindow after the first one, which
+     * the losses detected in the meantime share.
+     */
+    void ExpiryTimerExpire();
+
+    /**
+     * \brief Computes the MPR set and the routing table after the pending neighbor losses.
+     */
+    void LossTimerExpire();
+
+    /**
+     * \brief Removes the duplicate window of an originator if expired. Else timer is
+     * rescheduled to expire at window.expirationTime.
      *
-     * \param address The address of the tuple.
-     * \param sequenceNumber The sequence number of the tuple.
+     * \param address The originator address.
      */
-    void DupTupleTimerExpire(Ipv4Address address, uint16_t sequenceNumber);
+    void DupTupleTimerExpire(Ipv4Address address);
 
     bool m_linkTupleTimerFirstTime; //!< Flag to indicate if it is the first time the LinkTupleTimer
                                     //!< fires.
@@ -552,6 +896,14 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void TopologyTupleTimerExpire(Ipv4Address destAddr, Ipv4Address lastAddr);
 
+    /**
+     * \brief Removes a node position if expired. Else the timer is rescheduled to expire at
+     * the position expiration time.
+     *
+     * \param mainAddr The node main address.
+     */
+    void NodePositionTimerExpire(Ipv4Address mainAddr);
+
     /**
      * \brief Removes interface association tuple_ if expired. Else the timer is rescheduled to
      * expire at tuple_->time().
@@ -577,28 +929,51 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void IncrementAnsn();
 
+    /// Priority of a pending message, lower values being sent first.
+    enum class MessagePriority : uint8_t
+    {
+        HELLO,     //!< HELLO messages, needed for link sensing.
+        OWN,       //!< TC, MID and HNA messages originated by this node.
+        FORWARDED, //!< Messages forwarded on behalf of other nodes.
+    };
+
+    /// A pending message, already serialized.
+    struct QueuedMessage
+    {
+        Ptr<Packet> message;      //!< The serialized message.
+        MessagePriority priority; //!< The message priority.
+    };
+
     /// A list of pending messages which are buffered awaiting for being sent.
-    olsr::MessageList m_queuedMessages;
-    Timer m_queuedMessagesTimer; //!< timer for throttling outgoing messages
+    std::vector<QueuedMessage> m_queuedMessages;
+    Timer m_queuedMessagesTimer;   //!< timer for throttling outgoing messages
+    Time m_queuedMessagesDeadline; //!< Time the pending messages are sent at.
+    Time m_forwardingHoldTime;     //!< Extra delay of the forwarded messages.
+    uint32_t m_maxPacketSize;      //!< Largest %OLSR packet fitting the MTU of the interfaces.
+    uint32_t m_packetsSent;        //!< Number of %OLSR packets sent.
+    uint64_t m_packedBytes;        //!< Number of bytes of the %OLSR packets sent.
 
     /**
      * \brief OLSR's default forwarding algorithm.
      *
      * See \RFC{3626} for details.
      *
+     * The message is retransmitted by patching its time to live and hop count in the
+     * received bytes, without decoding its payload.
+     *
      * \param olsrMessage The %OLSR message which must be forwarded.
-     * \param duplicated NULL if the message has never been considered for forwarding, or a
-     * duplicate tuple in other case.
-     * \param localIface The address of the interface where the message was received from.
+     * \param duplicated true if the message is in the Duplicate Set.
+     * \param localIface The index of the interface where the message was received from.
      * \param senderAddress The sender IPv4 address.
      */
-    void ForwardDefault(olsr::MessageHeader olsrMessage,
-                        DuplicateTuple* duplicated,
-                        const Ipv4Address& localIface,
+    void ForwardDefault(olsr::MessageView& olsrMessage,
+                        bool duplicated,
+                        uint32_t localIface,
                         const Ipv4Address& senderAddress);
 
     /**
-     * \brief Enqueues an %OLSR message which will be sent with a delay of (0, delay].
+     * \brief Enqueues an %OLSR message originated by this node which will be sent with a delay
+     * of (0, delay].
      *
      * This buffering system is used in order to piggyback several %OLSR messages in
      * a same %OLSR packet.
@@ -608,11 +983,25 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void QueueMessage(const olsr::MessageHeader& message, Time delay);
 
+    /**
+     * \brief Enqueues an already serialized %OLSR message which will be sent with a delay of
+     * (0, delay].
+     *
+     * The pending messages are all sent at the earliest of their deadlines, so a message with
+     * a short delay, like a HELLO, brings forward the messages queued before it.
+     *
+     * \param message the serialized %OLSR message which must be sent.
+     * \param priority the message priority.
+     * \param delay maximum delay the %OLSR message is going to be buffered.
+     */
+    void QueueMessage(Ptr<Packet> message, MessagePriority priority, Time delay);
+
     /**
      * \brief Creates as many %OLSR packets as needed in order to send all buffered
      * %OLSR messages.
      *
-     * Maximum number of messages which can be contained in an %OLSR packet is
+     * Messages are packed by priority, then in order, into packets fitting the MTU of the
+     * interfaces. Maximum number of messages which can be contained in an %OLSR packet is
      * dictated by OLSR_MAX_MSGS constant.
      */
     void SendQueuedMessages();
@@ -623,10 +1012,39 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     void SendHello();
 
     /**
-     * \brief Creates a new %OLSR TC message which is buffered for being sent later on.
+     * \brief Creates a new %OLSR TC message which is buffered for being sent later on, unless
+     * there are no neighbors to advertise.
      */
     void SendTc();
 
+    /**
+     * \brief Gets the neighbors advertised in TC messages, according to the TC redundancy.
+     * \returns The main addresses of the advertised neighbors.
+     */
+    std::vector<Ipv4Address> GetAdvertisedNeighbors() const;
+
+    /**
+     * \brief Fills the neighbors advertised in a TC message and its ANSN, which is increased
+     * whenever the advertised neighbors change.
+     *
+     * With DifferentialTc, the TC message only carries the changes since the previous one, if
+     * the receivers can apply them and they are shorter.
+     *
+     * \param tc The TC message.
+     * \param advertised The neighbors to advertise.
+     * \param ttl The TTL of the TC message.
+     */
+    void FillTcNeighbors(olsr::MessageHeader::Tc& tc,
+                         std::vector<Ipv4Address> advertised,
+                         uint8_t ttl);
+
+    /**
+     * \brief Gets the TTL of the next TC message, cycling through the fisheye TTLs.
+     * \param [out] period Number of TC intervals until a TC message reaches as far again.
+     * \returns The TTL.
+     */
+    uint8_t GetNextTcTtl(uint32_t& period);
+
     /**
      * \brief Creates a new %OLSR MID message which is buffered for being sent later on.
      */
@@ -646,20 +1064,6 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void NeighborLoss(const LinkTuple& tuple);
 
-    /**
-     * \brief Adds a duplicate tuple to the Duplicate Set.
-     *
-     * \param tuple The duplicate tuple to be added.
-     */
-    void AddDuplicateTuple(const DuplicateTuple& tuple);
-
-    /**
-     * \brief Removes a duplicate tuple from the Duplicate Set.
-     *
-     * \param tuple The duplicate tuple to be removed.
-     */
-    void RemoveDuplicateTuple(const DuplicateTuple& tuple);
-
     /**
      * Adds a link tuple.
      * \param tuple The tuple to be added.
@@ -795,6 +1199,29 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& senderIface);
 
+    /**
+     * \brief Processes a differential TC message.
+     *
+     * The changes are only applied if the topology tuples of the originator all hold the base
+     * ANSN of the message; otherwise a message was missed, and the topology of the originator
+     * is left as is until its next full TC message.
+     *
+     * \param msg The %OLSR message which contains the TC message.
+     */
+    void ProcessTcDelta(const olsr::MessageHeader& msg);
+
+    /**
+     * \brief Refreshes the topology tuple of a neighbor advertised in a TC message, or records
+     * a new one.
+     *
+     * \param destAddr The advertised neighbor main address.
+     * \param msg The %OLSR message which contains the TC message.
+     * \param position The position of the originator.
+     */
+    void UpdateTopologyTuple(const Ipv4Address& destAddr,
+                             const olsr::MessageHeader& msg,
+                             const Vector& position);
+
     /**
      * \brief Processes a MID message following \RFC{3626} specification.
      *
@@ -861,6 +1288,10 @@ class RoutingProtocol : public Ipv4RoutingProtocol
 
     int Degree(const NeighborTuple& tuple);
 
+    /// Cached degrees, indexed by neighbor main address.
+    std::unordered_map<Ipv4Address, int, Ipv4AddressHash> m_degrees;
+    uint32_t m_degreesVersion; //!< Neighborhood version the cached degrees were computed for.
+
     /**
      * Check that address is one of my interfaces.
      * \param a the address to check.
@@ -875,6 +1306,8 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     // HELLO messages arrive)
     std::map<Ptr<Socket>, Ipv4InterfaceAddress>
         m_sendSockets;        //!< Container of sockets and the interfaces they are opened onto.
+    std::vector<std::pair<Ptr<Socket>, InetSocketAddress>>
+        m_broadcastDestinations; //!< Sockets and the broadcast destinations they send to.
     Ptr<Socket> m_recvSocket; //!< Receiving socket.
 
     /// Rx packet trace.
@@ -886,6 +1319,12 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     /// Routing table changes callback
     TracedCallback<uint32_t> m_routingTableChanged;
 
+    /// Tracks the MPR and routing table computations saved by an expiry sweep.
+    TracedCallback<uint32_t> m_recomputationsSavedTrace;
+
+    /// Tracks the size of the packets the queued messages are packed into.
+    TracedCallback<uint32_t, uint32_t> m_packetPackingTrace;
+
     /// Provides uniform random variables.
     Ptr<UniformRandomVariable> m_uniformRandomVariable;
 };
@@ -27,42 +27,248 @@
 
 #include "olsr-state.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace ns3
 {
 namespace olsr
 {
 
-/********** MPR Selector Set Manipulation **********/
+namespace
+{
 
-MprSelectorTuple*
-OlsrState::FindMprSelectorTuple(const Ipv4Address& mainAddr)
+/********** Tuple index keys **********/
+
+Ipv4Address
+LinkKey(const LinkTuple& tuple)
+{
+    return tuple.neighborIfaceAddr;
+}
+
+Ipv4Address
+NeighborKey(const NeighborTuple& tuple)
+{
+    return tuple.neighborMainAddr;
+}
+
+std::pair<Ipv4Address, Ipv4Address>
+TwoHopNeighborKey(const TwoHopNeighborTuple& tuple)
+{
+    return std::make_pair(tuple.neighborMainAddr, tuple.twoHopNeighborAddr);
+}
+
+std::pair<Ipv4Address, Ipv4Address>
+TopologyKey(const TopologyTuple& tuple)
+{
+    return std::make_pair(tuple.destAddr, tuple.lastAddr);
+}
+
+Ipv4Address
+MprSelectorKey(const MprSelectorTuple& tuple)
 {
-    for (auto it = m_mprSelectorSet.begin(); it != m_mprSelectorSet.end(); it++)
+    return tuple.mainAddr;
+}
+
+Ipv4Address
+IfaceAssocKey(const IfaceAssocTuple& tuple)
+{
+    return tuple.ifaceAddr;
+}
+
+/********** Tuple index maintenance **********/
+
+///
+/// \brief Rebuilds an index from scratch.
+///
+/// Each key is mapped to the position of the first tuple holding it, which
+/// keeps lookups equivalent to a front-to-back scan of the set.
+///
+/// \param set The indexed set.
+/// \param index The index to rebuild.
+/// \param key Function returning the key of a tuple.
+///
+template <typename Set, typename Index, typename KeyFunction>
+void
+RebuildIndex(const Set& set, Index& index, KeyFunction key)
+{
+    index.clear();
+    index.reserve(set.size());
+    for (std::size_t pos = 0; pos < set.size(); pos++)
     {
-        if (it->mainAddr == mainAddr)
+        index.emplace(key(set[pos]), pos);
+    }
+}
+
+///
+/// \brief Looks up a tuple through its index.
+///
+/// \param set The indexed set.
+/// \param index The index of the set.
+/// \param key The key to look for.
+/// \return The first tuple with the given key, or a null pointer if no match.
+///
+template <typename Set, typename Index, typename Key>
+auto
+FindIndexed(Set& set, const Index& index, const Key& key) -> decltype(&set[0])
+{
+    auto it = index.find(key);
+    if (it == index.end())
+    {
+        return nullptr;
+    }
+    return &set[it->second];
+}
+
+///
+/// \brief Appends a tuple to a set and records it in the index.
+///
+/// \param set The indexed set.
+/// \param index The index of the set.
+/// \param tuple The tuple to append.
+/// \param key Function returning the key of a tuple.
+///
+template <typename Set, typename Index, typename KeyFunction>
+void
+InsertIndexed(Set& set, Index& index, const typename Set::value_type& tuple, KeyFunction key)
+{
+    // emplace () keeps an existing entry, so the index still points to the first match
+    index.emplace(key(tuple), set.size());
+    set.push_back(tuple);
+}
+
+///
+/// \brief Erases a tuple from a set and updates the index positions.
+///
+/// \param set The indexed set.
+/// \param index The index of the set.
+/// \param it Iterator to the tuple to erase.
+/// \param key Function returning the key of a tuple.
+///
+template <typename Set, typename Index, typename KeyFunction>
+void
+EraseIndexed(Set& set, Index& index, typename Set::iterator it, KeyFunction key)
+{
+    const std::size_t erasedPos = it - set.begin();
+    const auto erasedKey = key(*it);
+    auto entry = index.find(erasedKey);
+    const bool wasIndexed = (entry != index.end() && entry->second == erasedPos);
+    if (wasIndexed)
+    {
+        index.erase(entry);
+    }
+
+    set.erase(it);
+    for (auto& indexEntry : index)
+    {
+        if (indexEntry.second > erasedPos)
         {
-            return &(*it);
+            indexEntry.second--;
+        }
+    }
+
+    // If the erased tuple was the indexed one, a later tuple with the same key takes its place.
+    if (wasIndexed)
+    {
+        for (std::size_t pos = erasedPos; pos < set.size(); pos++)
+        {
+            if (key(set[pos]) == erasedKey)
+            {
+                index.emplace(erasedKey, pos);
+                break;
+            }
         }
     }
-    return nullptr;
 }
 
-void
-OlsrState::EraseMprSelectorTuple(const MprSelectorTuple& tuple)
+///
+/// \brief Erases a tuple equal to the given one, locating it through the index.
+///
+/// \param set The indexed set.
+/// \param index The index of the set.
+/// \param tuple The tuple to erase.
+/// \param key Function returning the key of a tuple.
+/// \return true if a tuple was erased.
+///
+template <typename Set, typename Index, typename KeyFunction>
+bool
+EraseEqualIndexed(Set& set,
+                  Index& index,
+                  const typename Set::value_type& tuple,
+                  KeyFunction key)
 {
-    for (auto it = m_mprSelectorSet.begin(); it != m_mprSelectorSet.end(); it++)
+    auto entry = index.find(key(tuple));
+    if (entry == index.end())
     {
-        if (*it == tuple)
+        return false;
+    }
+    auto it = set.begin() + entry->second;
+    if (!(*it == tuple))
+    {
+        // The tuple equality may involve more than the key fields
+        it = std::find(it + 1, set.end(), tuple);
+        if (it == set.end())
         {
-            m_mprSelectorSet.erase(it);
-            break;
+            return false;
         }
     }
+    EraseIndexed(set, index, it, key);
+    return true;
+}
+
+/********** Duplicate windows **********/
+
+///
+/// \brief Computes how much older a sequence number is than the most recent one of a window.
+///
+/// Sequence numbers are compared with serial number arithmetic (\RFC{1982}), so that
+/// the comparison holds when the 16-bit sequence numbers wrap around.
+///
+/// \param window The duplicate window.
+/// \param sequenceNumber The sequence number.
+/// \return The age of the sequence number, negative if it is newer than the window.
+///
+int32_t
+SequenceAge(const DuplicateWindow& window, uint16_t sequenceNumber)
+{
+    return static_cast<int16_t>(static_cast<uint16_t>(window.lastSequenceNumber - sequenceNumber));
+}
+
+///
+/// \brief Gets the bit of an interface in DuplicateWindow::ifaces.
+///
+/// \param iface The interface index.
+/// \return The interface bit.
+///
+uint8_t
+InterfaceBit(uint32_t iface)
+{
+    return 1 << (iface % 8);
+}
+
+} // unnamed namespace
+
+/********** MPR Selector Set Manipulation **********/
+
+MprSelectorTuple*
+OlsrState::FindMprSelectorTuple(const Ipv4Address& mainAddr)
+{
+    return FindIndexed(m_mprSelectorSet, m_mprSelectorIndex, mainAddr);
+}
+
+void
+OlsrState::EraseMprSelectorTuple(const MprSelectorTuple& tuple)
+{
+    EraseEqualIndexed(m_mprSelectorSet, m_mprSelectorIndex, tuple, MprSelectorKey);
 }
 
 void
 OlsrState::EraseMprSelectorTuples(const Ipv4Address& mainAddr)
 {
+    if (m_mprSelectorIndex.find(mainAddr) == m_mprSelectorIndex.end())
+    {
+        return;
+    }
     for (auto it = m_mprSelectorSet.begin(); it != m_mprSelectorSet.end();)
     {
         if (it->mainAddr == mainAddr)
@@ -74,12 +280,13 @@ OlsrState::EraseMprSelectorTuples(const Ipv4Address& mainAddr)
             it++;
         }
     }
+    RebuildIndex(m_mprSelectorSet, m_mprSelectorIndex, MprSelectorKey);
 }
 
 void
 OlsrState::InsertMprSelectorTuple(const MprSelectorTuple& tuple)
 {
-    m_mprSelectorSet.push_back(tuple);
+    InsertIndexed(m_mprSelectorSet, m_mprSelectorIndex, tuple, MprSelectorKey);
 }
 
 std::string
@@ -106,25 +313,16 @@ OlsrState::PrintMprSelectorSet() const
 NeighborTuple*
 OlsrState::FindNeighborTuple(const Ipv4Address& mainAddr)
 {
-    for (auto it = m_neighborSet.begin(); it != m_neighborSet.end(); it++)
-    {
-        if (it->neighborMainAddr == mainAddr)
-        {
-            return &(*it);
-        }
-    }
-    return nullptr;
+    return FindIndexed(m_neighborSet, m_neighborIndex, mainAddr);
 }
 
 const NeighborTuple*
 OlsrState::FindSymNeighborTuple(const Ipv4Address& mainAddr) const
 {
-    for (auto it = m_neighborSet.begin(); it != m_neighborSet.end(); it++)
+    const NeighborTuple* tuple = FindIndexed(m_neighborSet, m_neighborIndex, mainAddr);
+    if (tuple != nullptr && tuple->status == NeighborTuple::STATUS_SYM)
     {
-        if (it->neighborMainAddr == mainAddr && it->status == NeighborTuple::STATUS_SYM)
-        {
-            return &(*it);
-        }
+        return tuple;
     }
     return nullptr;
 }
@@ -132,12 +330,10 @@ OlsrState::FindSymNeighborTuple(const Ipv4Address& mainAddr) const
 NeighborTuple*
 OlsrState::FindNeighborTuple(const Ipv4Address& mainAddr, Willingness willingness)
 {
-    for (auto it = m_neighborSet.begin(); it != m_neighborSet.end(); it++)
+    NeighborTuple* tuple = FindIndexed(m_neighborSet, m_neighborIndex, mainAddr);
+    if (tuple != nullptr && tuple->willingness == willingness)
     {
-        if (it->neighborMainAddr == mainAddr && it->willingness == willingness)
-        {
-            return &(*it);
-        }
+        return tuple;
     }
     return nullptr;
 }
@@ -145,42 +341,46 @@ OlsrState::FindNeighborTuple(const Ipv4Address& mainAddr, Willingness willingnes
 void
 OlsrState::EraseNeighborTuple(const NeighborTuple& tuple)
 {
-    for (auto it = m_neighborSet.begin(); it != m_neighborSet.end(); it++)
+    if (EraseEqualIndexed(m_neighborSet, m_neighborIndex, tuple, NeighborKey))
     {
-        if (*it == tuple)
-        {
-            m_neighborSet.erase(it);
-            break;
-        }
+        m_neighborhoodVersion++;
     }
 }
 
 void
 OlsrState::EraseNeighborTuple(const Ipv4Address& mainAddr)
 {
-    for (auto it = m_neighborSet.begin(); it != m_neighborSet.end(); it++)
+    auto entry = m_neighborIndex.find(mainAddr);
+    if (entry != m_neighborIndex.end())
     {
-        if (it->neighborMainAddr == mainAddr)
-        {
-            it = m_neighborSet.erase(it);
-            break;
-        }
+        EraseIndexed(m_neighborSet,
+                     m_neighborIndex,
+                     m_neighborSet.begin() + entry->second,
+                     NeighborKey);
+        m_neighborhoodVersion++;
     }
 }
 
 void
 OlsrState::InsertNeighborTuple(const NeighborTuple& tuple)
 {
-    for (auto it = m_neighborSet.begin(); it != m_neighborSet.end(); it++)
+    NeighborTuple* existing = FindNeighborTuple(tuple.neighborMainAddr);
+    if (existing != nullptr)
     {
-        if (it->neighborMainAddr == tuple.neighborMainAddr)
-        {
-            // Update it
-            *it = tuple;
-            return;
-        }
+        // Update it
+        *existing = tuple;
+        return;
     }
-    m_neighborSet.push_back(tuple);
+    InsertIndexed(m_neighborSet, m_neighborIndex, tuple, NeighborKey);
+    m_neighborhoodVersion++;
+}
+
+void
+OlsrState::ReindexNeighbors()
+{
+    RebuildIndex(m_neighborSet, m_neighborIndex, NeighborKey);
+    RebuildIndex(m_twoHopNeighborSet, m_twoHopNeighborIndex, TwoHopNeighborKey);
+    m_neighborhoodVersion++;
 }
 
 /********** Neighbor 2 Hop Set Manipulation **********/
@@ -189,27 +389,17 @@ TwoHopNeighborTuple*
 OlsrState::FindTwoHopNeighborTuple(const Ipv4Address& neighborMainAddr,
                                    const Ipv4Address& twoHopNeighborAddr)
 {
-    for (auto it = m_twoHopNeighborSet.begin(); it != m_twoHopNeighborSet.end(); it++)
-    {
-        if (it->neighborMainAddr == neighborMainAddr &&
-            it->twoHopNeighborAddr == twoHopNeighborAddr)
-        {
-            return &(*it);
-        }
-    }
-    return nullptr;
+    return FindIndexed(m_twoHopNeighborSet,
+                       m_twoHopNeighborIndex,
+                       std::make_pair(neighborMainAddr, twoHopNeighborAddr));
 }
 
 void
 OlsrState::EraseTwoHopNeighborTuple(const TwoHopNeighborTuple& tuple)
 {
-    for (auto it = m_twoHopNeighborSet.begin(); it != m_twoHopNeighborSet.end(); it++)
+    if (EraseEqualIndexed(m_twoHopNeighborSet, m_twoHopNeighborIndex, tuple, TwoHopNeighborKey))
     {
-        if (*it == tuple)
-        {
-            m_twoHopNeighborSet.erase(it);
-            break;
-        }
+        m_neighborhoodVersion++;
     }
 }
 
@@ -217,6 +407,11 @@ void
 OlsrState::EraseTwoHopNeighborTuples(const Ipv4Address& neighborMainAddr,
                                      const Ipv4Address& twoHopNeighborAddr)
 {
+    if (m_twoHopNeighborIndex.find(std::make_pair(neighborMainAddr, twoHopNeighborAddr)) ==
+        m_twoHopNeighborIndex.end())
+    {
+        return;
+    }
     for (auto it = m_twoHopNeighborSet.begin(); it != m_twoHopNeighborSet.end();)
     {
         if (it->neighborMainAddr == neighborMainAddr &&
@@ -229,28 +424,38 @@ OlsrState::EraseTwoHopNeighborTuples(const Ipv4Address& neighborMainAddr,
             it++;
         }
     }
+    RebuildIndex(m_twoHopNeighborSet, m_twoHopNeighborIndex, TwoHopNeighborKey);
+    m_neighborhoodVersion++;
 }
 
 void
 OlsrState::EraseTwoHopNeighborTuples(const Ipv4Address& neighborMainAddr)
 {
+    bool erased = false;
     for (auto it = m_twoHopNeighborSet.begin(); it != m_twoHopNeighborSet.end();)
     {
         if (it->neighborMainAddr == neighborMainAddr)
         {
             it = m_twoHopNeighborSet.erase(it);
+            erased = true;
         }
         else
         {
             it++;
         }
     }
+    if (erased)
+    {
+        RebuildIndex(m_twoHopNeighborSet, m_twoHopNeighborIndex, TwoHopNeighborKey);
+        m_neighborhoodVersion++;
+    }
 }
 
 void
 OlsrState::InsertTwoHopNeighborTuple(const TwoHopNeighborTuple& tuple)
 {
-    m_twoHopNeighborSet.push_back(tuple);
+    InsertIndexed(m_twoHopNeighborSet, m_twoHopNeighborIndex, tuple, TwoHopNeighborKey);
+    m_neighborhoodVersion++;
 }
 
 /********** MPR Set Manipulation **********/
@@ -276,36 +481,127 @@ OlsrState::GetMprSet() const
 
 /********** Duplicate Set Manipulation **********/
 
-DuplicateTuple*
-OlsrState::FindDuplicateTuple(const Ipv4Address& addr, uint16_t sequenceNumber)
+bool
+OlsrState::IsDuplicate(const Ipv4Address& address, uint16_t sequenceNumber) const
 {
-    for (auto it = m_duplicateSet.begin(); it != m_duplicateSet.end(); it++)
+    const DuplicateWindow* window = FindDuplicateWindow(address);
+    if (window == nullptr)
     {
-        if (it->address == addr && it->sequenceNumber == sequenceNumber)
-        {
-            return &(*it);
-        }
+        return false;
     }
-    return nullptr;
+    int32_t age = SequenceAge(*window, sequenceNumber);
+    if (age < 0)
+    {
+        return false;
+    }
+    if (age >= DuplicateWindow::WINDOW_SIZE)
+    {
+        return true;
+    }
+    return window->ifaces[sequenceNumber % DuplicateWindow::WINDOW_SIZE] != 0;
 }
 
-void
-OlsrState::EraseDuplicateTuple(const DuplicateTuple& tuple)
+bool
+OlsrState::IsDuplicateOnInterface(const Ipv4Address& address,
+                                  uint16_t sequenceNumber,
+                                  uint32_t iface) const
 {
-    for (auto it = m_duplicateSet.begin(); it != m_duplicateSet.end(); it++)
+    const DuplicateWindow* window = FindDuplicateWindow(address);
+    if (window == nullptr)
     {
-        if (*it == tuple)
+        return false;
+    }
+    int32_t age = SequenceAge(*window, sequenceNumber);
+    if (age < 0)
+    {
+        return false;
+    }
+    if (age >= DuplicateWindow::WINDOW_SIZE)
+    {
+        return true;
+    }
+    return window->ifaces[sequenceNumber % DuplicateWindow::WINDOW_SIZE] & InterfaceBit(iface);
+}
+
+bool
+OlsrState::IsRetransmitted(const Ipv4Address& address, uint16_t sequenceNumber) const
+{
+    const DuplicateWindow* window = FindDuplicateWindow(address);
+    if (window == nullptr)
+    {
+        return false;
+    }
+    int32_t age = SequenceAge(*window, sequenceNumber);
+    if (age < 0)
+    {
+        return false;
+    }
+    if (age >= DuplicateWindow::WINDOW_SIZE)
+    {
+        return true;
+    }
+    return window->retransmitted[sequenceNumber % DuplicateWindow::WINDOW_SIZE];
+}
+
+bool
+OlsrState::InsertDuplicate(const Ipv4Address& address,
+                           uint16_t sequenceNumber,
+                           uint32_t iface,
+                           bool retransmitted,
+                           Time expirationTime)
+{
+    auto result = m_duplicateSet.try_emplace(address);
+    DuplicateWindow& window = result.first->second;
+    if (result.second)
+    {
+        window.lastSequenceNumber = sequenceNumber;
+        std::fill(std::begin(window.ifaces), std::end(window.ifaces), 0);
+        window.retransmitted.reset();
+        window.expirationTime = expirationTime;
+    }
+
+    int32_t age = SequenceAge(window, sequenceNumber);
+    if (age >= DuplicateWindow::WINDOW_SIZE)
+    {
+        // Too old to be recorded, and already reported as a duplicate anyway
+        return result.second;
+    }
+    if (age < 0)
+    {
+        // Slide the window forward, clearing the slots of the skipped sequence numbers
+        int32_t advance = std::min<int32_t>(-age, DuplicateWindow::WINDOW_SIZE);
+        for (int32_t i = 0; i < advance; i++)
         {
-            m_duplicateSet.erase(it);
-            break;
+            uint16_t slot =
+                static_cast<uint16_t>(sequenceNumber - i) % DuplicateWindow::WINDOW_SIZE;
+            window.ifaces[slot] = 0;
+            window.retransmitted[slot] = false;
         }
+        window.lastSequenceNumber = sequenceNumber;
+    }
+
+    uint16_t slot = sequenceNumber % DuplicateWindow::WINDOW_SIZE;
+    window.ifaces[slot] |= InterfaceBit(iface);
+    window.retransmitted[slot] = retransmitted;
+    window.expirationTime = std::max(window.expirationTime, expirationTime);
+    return result.second;
+}
+
+const DuplicateWindow*
+OlsrState::FindDuplicateWindow(const Ipv4Address& address) const
+{
+    auto it = m_duplicateSet.find(address);
+    if (it == m_duplicateSet.end())
+    {
+        return nullptr;
     }
+    return &it->second;
 }
 
 void
-OlsrState::InsertDuplicateTuple(const DuplicateTuple& tuple)
+OlsrState::EraseDuplicateWindow(const Ipv4Address& address)
 {
-    m_duplicateSet.push_back(tuple);
+    m_duplicateSet.erase(address);
 }
 
 /********** Link Set Manipulation **********/
@@ -313,32 +609,16 @@ OlsrState::InsertDuplicateTuple(const DuplicateTuple& tuple)
 LinkTuple*
 OlsrState::FindLinkTuple(const Ipv4Address& ifaceAddr)
 {
-    for (auto it = m_linkSet.begin(); it != m_linkSet.end(); it++)
-    {
-        if (it->neighborIfaceAddr == ifaceAddr)
-        {
-            return &(*it);
-        }
-    }
-    return nullptr;
+    return FindIndexed(m_linkSet, m_linkIndex, ifaceAddr);
 }
 
 LinkTuple*
 OlsrState::FindSymLinkTuple(const Ipv4Address& ifaceAddr, Time now)
 {
-    for (auto it = m_linkSet.begin(); it != m_linkSet.end(); it++)
+    LinkTuple* tuple = FindIndexed(m_linkSet, m_linkIndex, ifaceAddr);
+    if (tuple != nullptr && tuple->symTime > now)
     {
-        if (it->neighborIfaceAddr == ifaceAddr)
-        {
-            if (it->symTime > now)
-            {
-                return &(*it);
-            }
-            else
-            {
-                break;
-            }
-        }
+        return tuple;
     }
     return nullptr;
 }
@@ -346,20 +626,13 @@ OlsrState::FindSymLinkTuple(const Ipv4Address& ifaceAddr, Time now)
 void
 OlsrState::EraseLinkTuple(const LinkTuple& tuple)
 {
-    for (auto it = m_linkSet.begin(); it != m_linkSet.end(); it++)
-    {
-        if (*it == tuple)
-        {
-            m_linkSet.erase(it);
-            break;
-        }
-    }
+    EraseEqualIndexed(m_linkSet, m_linkIndex, tuple, LinkKey);
 }
 
 LinkTuple&
 OlsrState::InsertLinkTuple(const LinkTuple& tuple)
 {
-    m_linkSet.push_back(tuple);
+    InsertIndexed(m_linkSet, m_linkIndex, tuple, LinkKey);
     return m_linkSet.back();
 }
 
@@ -368,14 +641,7 @@ OlsrState::InsertLinkTuple(const LinkTuple& tuple)
 TopologyTuple*
 OlsrState::FindTopologyTuple(const Ipv4Address& destAddr, const Ipv4Address& lastAddr)
 {
-    for (auto it = m_topologySet.begin(); it != m_topologySet.end(); it++)
-    {
-        if (it->destAddr == destAddr && it->lastAddr == lastAddr)
-        {
-            return &(*it);
-        }
-    }
-    return nullptr;
+    return FindIndexed(m_topologySet, m_topologyIndex, std::make_pair(destAddr, lastAddr));
 }
 
 TopologyTuple*
@@ -394,36 +660,56 @@ OlsrState::FindNewerTopologyTuple(const Ipv4Address& lastAddr, uint16_t ansn)
 void
 OlsrState::EraseTopologyTuple(const TopologyTuple& tuple)
 {
-    for (auto it = m_topologySet.begin(); it != m_topologySet.end(); it++)
-    {
-        if (*it == tuple)
-        {
-            m_topologySet.erase(it);
-            break;
-        }
-    }
+    EraseEqualIndexed(m_topologySet, m_topologyIndex, tuple, TopologyKey);
 }
 
 void
 OlsrState::EraseOlderTopologyTuples(const Ipv4Address& lastAddr, uint16_t ansn)
 {
+    bool erased = false;
     for (auto it = m_topologySet.begin(); it != m_topologySet.end();)
     {
         if (it->lastAddr == lastAddr && it->sequenceNumber < ansn)
         {
             it = m_topologySet.erase(it);
+            erased = true;
         }
         else
         {
             it++;
         }
     }
+    if (erased)
+    {
+        RebuildIndex(m_topologySet, m_topologyIndex, TopologyKey);
+    }
+}
+
+uint32_t
+OlsrState::EraseTopologyTuples(const Ipv4Address& lastAddr,
+                               const std::vector<Ipv4Address>& destAddrs)
+{
+    auto end = std::remove_if(m_topologySet.begin(),
+                              m_topologySet.end(),
+                              [&lastAddr, &destAddrs](const TopologyTuple& tuple) {
+                                  return tuple.lastAddr == lastAddr &&
+                                         std::find(destAddrs.begin(),
+                                                   destAddrs.end(),
+                                                   tuple.destAddr) != destAddrs.end();
+                              });
+    uint32_t erased = m_topologySet.end() - end;
+    if (erased > 0)
+    {
+        m_topologySet.erase(end, m_topologySet.end());
+        RebuildIndex(m_topologySet, m_topologyIndex, TopologyKey);
+    }
+    return erased;
 }
 
 void
 OlsrState::InsertTopologyTuple(const TopologyTuple& tuple)
 {
-    m_topologySet.push_back(tuple);
+    InsertIndexed(m_topologySet, m_topologyIndex, tuple, TopologyKey);
 }
 
 /********** Interface Association Set Manipulation **********/
@@ -431,46 +717,25 @@ OlsrState::InsertTopologyTuple(const TopologyTuple& tuple)
 IfaceAssocTuple*
 OlsrState::FindIfaceAssocTuple(const Ipv4Address& ifaceAddr)
 {
-    for (auto it = m_ifaceAssocSet.begin(); it != m_ifaceAssocSet.end(); it++)
-    {
-        if (it->ifaceAddr == ifaceAddr)
-        {
-            return &(*it);
-        }
-    }
-    return nullptr;
+    return FindIndexed(m_ifaceAssocSet, m_ifaceAssocIndex, ifaceAddr);
 }
 
 const IfaceAssocTuple*
 OlsrState::FindIfaceAssocTuple(const Ipv4Address& ifaceAddr) const
 {
-    for (auto it = m_ifaceAssocSet.begin(); it != m_ifaceAssocSet.end(); it++)
-    {
-        if (it->ifaceAddr == ifaceAddr)
-        {
-            return &(*it);
-        }
-    }
-    return nullptr;
+    return FindIndexed(m_ifaceAssocSet, m_ifaceAssocIndex, ifaceAddr);
 }
 
 void
 OlsrState::EraseIfaceAssocTuple(const IfaceAssocTuple& tuple)
 {
-    for (auto it = m_ifaceAssocSet.begin(); it != m_ifaceAssocSet.end(); it++)
-    {
-        if (*it == tuple)
-        {
-            m_ifaceAssocSet.erase(it);
-            break;
-        }
-    }
+    EraseEqualIndexed(m_ifaceAssocSet, m_ifaceAssocIndex, tuple, IfaceAssocKey);
 }
 
 void
 OlsrState::InsertIfaceAssocTuple(const IfaceAssocTuple& tuple)
 {
-    m_ifaceAssocSet.push_back(tuple);
+    InsertIndexed(m_ifaceAssocSet, m_ifaceAssocIndex, tuple, IfaceAssocKey);
 }
 
 std::vector<Ipv4Address>
@@ -543,5 +808,126 @@ OlsrState::InsertAssociation(const Association& tuple)
     m_associations.push_back(tuple);
 }
 
+/********** Node Positions Manipulation **********/
+
+bool
+OlsrState::UpdateNodePosition(const Ipv4Address& mainAddr,
+                              const Vector& position,
+                              const Vector& velocity,
+                              Time updateTime,
+                              Time expirationTime)
+{
+    auto entry = m_nodePositionIndex.find(mainAddr);
+    if (entry == m_nodePositionIndex.end())
+    {
+        m_nodePositionIndex.emplace(mainAddr, m_nodePositionAddr.size());
+        m_nodePositionAddr.push_back(mainAddr);
+        m_nodePositionX.push_back(position.x);
+        m_nodePositionY.push_back(position.y);
+        m_nodePositionZ.push_back(position.z);
+        m_nodeVelocityX.push_back(velocity.x);
+        m_nodeVelocityY.push_back(velocity.y);
+        m_nodeVelocityZ.push_back(velocity.z);
+        m_nodePositionUpdateTime.push_back(updateTime);
+        m_nodePositionExpirationTime.push_back(expirationTime);
+        return true;
+    }
+
+    std::size_t index = entry->second;
+    m_nodePositionExpirationTime[index] =
+        std::max(m_nodePositionExpirationTime[index], expirationTime);
+    if (updateTime < m_nodePositionUpdateTime[index])
+    {
+        return false;
+    }
+
+    bool changed = (m_nodePositionX[index] != position.x || m_nodePositionY[index] != position.y ||
+                    m_nodePositionZ[index] != position.z || m_nodeVelocityX[index] != velocity.x ||
+                    m_nodeVelocityY[index] != velocity.y || m_nodeVelocityZ[index] != velocity.z);
+    m_nodePositionX[index] = position.x;
+    m_nodePositionY[index] = position.y;
+    m_nodePositionZ[index] = position.z;
+    m_nodeVelocityX[index] = velocity.x;
+    m_nodeVelocityY[index] = velocity.y;
+    m_nodeVelocityZ[index] = velocity.z;
+    m_nodePositionUpdateTime[index] = updateTime;
+    return changed;
+}
+
+bool
+OlsrState::RefreshNodePosition(const Ipv4Address& mainAddr, Time expirationTime)
+{
+    auto entry = m_nodePositionIndex.find(mainAddr);
+    if (entry == m_nodePositionIndex.end())
+    {
+        return false;
+    }
+    m_nodePositionExpirationTime[entry->second] =
+        std::max(m_nodePositionExpirationTime[entry->second], expirationTime);
+    return true;
+}
+
+int32_t
+OlsrState::FindNodePosition(const Ipv4Address& mainAddr) const
+{
+    auto entry = m_nodePositionIndex.find(mainAddr);
+    if (entry == m_nodePositionIndex.end())
+    {
+        return -1;
+    }
+    return entry->second;
+}
+
+void
+OlsrState::EraseNodePosition(const Ipv4Address& mainAddr)
+{
+    auto entry = m_nodePositionIndex.find(mainAddr);
+    if (entry == m_nodePositionIndex.end())
+    {
+        return;
+    }
+
+    // Move the last position into the erased slot to keep the arrays dense
+    std::size_t index = entry->second;
+    std::size_t last = m_nodePositionAddr.size() - 1;
+    m_nodePositionIndex.erase(entry);
+    if (index != last)
+    {
+        m_nodePositionAddr[index] = m_nodePositionAddr[last];
+        m_nodePositionX[index] = m_nodePositionX[last];
+        m_nodePositionY[index] = m_nodePositionY[last];
+        m_nodePositionZ[index] = m_nodePositionZ[last];
+        m_nodeVelocityX[index] = m_nodeVelocityX[last];
+        m_nodeVelocityY[index] = m_nodeVelocityY[last];
+        m_nodeVelocityZ[index] = m_nodeVelocityZ[last];
+        m_nodePositionUpdateTime[index] = m_nodePositionUpdateTime[last];
+        m_nodePositionExpirationTime[index] = m_nodePositionExpirationTime[last];
+        m_nodePositionIndex[m_nodePositionAddr[index]] = index;
+    }
+    m_nodePositionAddr.pop_back();
+    m_nodePositionX.pop_back();
+    m_nodePositionY.pop_back();
+    m_nodePositionZ.pop_back();
+    m_nodeVelocityX.pop_back();
+    m_nodeVelocityY.pop_back();
+    m_nodeVelocityZ.pop_back();
+    m_nodePositionUpdateTime.pop_back();
+    m_nodePositionExpirationTime.pop_back();
+}
+
+double
+OlsrState::GetMaxNodeSpeed() const
+{
+    double maxSquared = 0;
+    for (std::size_t i = 0; i < m_nodeVelocityX.size(); i++)
+    {
+        maxSquared = std::max(maxSquared,
+                              m_nodeVelocityX[i] * m_nodeVelocityX[i] +
+                                  m_nodeVelocityY[i] * m_nodeVelocityY[i] +
+                                  m_nodeVelocityZ[i] * m_nodeVelocityZ[i]);
+    }
+    return std::sqrt(maxSquared);
+}
+
 } // namespace olsr
 } // namespace ns3
@@ -24,6 +24,9 @@
 
 #include "olsr-repositories.h"
 
+#include <unordered_map>
+#include <utility>
+
 namespace ns3
 {
 namespace olsr
@@ -50,8 +53,54 @@ class OlsrState
     Associations m_associations;     //!< The node's local Host Network Associations that will be
                                      //!< advertised using HNA messages.
 
+    /// Key of the tuples identified by two addresses.
+    typedef std::pair<Ipv4Address, Ipv4Address> AddressPair;
+
+    /// Hash functor for AddressPair keys.
+    struct AddressPairHash
+    {
+        /**
+         * Hashes an address pair.
+         * \param key The address pair.
+         * \return The hash value.
+         */
+        std::size_t operator()(const AddressPair& key) const
+        {
+            return std::hash<uint64_t>()((static_cast<uint64_t>(key.first.Get()) << 32) |
+                                         key.second.Get());
+        }
+    };
+
+    /// Maps an address to the position of the first tuple holding it.
+    typedef std::unordered_map<Ipv4Address, std::size_t, Ipv4AddressHash> AddressIndex;
+    /// Maps an address pair to the position of the first tuple holding it.
+    typedef std::unordered_map<AddressPair, std::size_t, AddressPairHash> AddressPairIndex;
+
+    AddressIndex m_linkIndex;               //!< Link Set index, by neighbor interface address.
+    AddressIndex m_neighborIndex;           //!< Neighbor Set index, by neighbor main address.
+    AddressPairIndex m_twoHopNeighborIndex; //!< 2-hop Neighbor Set index, by (neighbor, 2-hop).
+    AddressPairIndex m_topologyIndex;       //!< Topology Set index, by (destination, last hop).
+    AddressIndex m_mprSelectorIndex;        //!< MPR Selector Set index, by main address.
+    AddressIndex m_ifaceAssocIndex;         //!< Interface Association Set index, by interface.
+
+    uint32_t m_neighborhoodVersion; //!< Number of changes made to the neighbor and 2-hop
+                                    //!< neighbor addresses.
+
+    // Node positions advertised in HELLO and TC messages, stored as parallel arrays.
+    AddressIndex m_nodePositionIndex;               //!< Node position index, by main address.
+    std::vector<Ipv4Address> m_nodePositionAddr;    //!< Main address of each node.
+    std::vector<double> m_nodePositionX;            //!< X coordinate of each node.
+    std::vector<double> m_nodePositionY;            //!< Y coordinate of each node.
+    std::vector<double> m_nodePositionZ;            //!< Z coordinate of each node.
+    std::vector<double> m_nodeVelocityX;            //!< X velocity of each node.
+    std::vector<double> m_nodeVelocityY;            //!< Y velocity of each node.
+    std::vector<double> m_nodeVelocityZ;            //!< Z velocity of each node.
+    std::vector<Time> m_nodePositionUpdateTime;     //!< Reception time of each position.
+    std::vector<Time> m_nodePositionExpirationTime; //!< Expiration time of each position.
+
   public:
     OlsrState()
+        : m_neighborhoodVersion(0)
     {
     }
 
@@ -110,6 +159,10 @@ class OlsrState
 
     /**
      * Gets the neighbor set.
+     *
+     * If the neighbor main addresses are modified through this reference,
+     * ReindexNeighbors() must be called afterwards.
+     *
      * \returns The neighbor set.
      */
     NeighborSet& GetNeighbors()
@@ -169,6 +222,10 @@ class OlsrState
 
     /**
      * Gets the 2-hop neighbor set.
+     *
+     * If the tuple addresses are modified through this reference,
+     * ReindexNeighbors() must be called afterwards.
+     *
      * \returns The 2-hop neighbor set.
      */
     TwoHopNeighborSet& GetTwoHopNeighbors()
@@ -176,6 +233,26 @@ class OlsrState
         return m_twoHopNeighborSet;
     }
 
+    /**
+     * Rebuilds the lookup indexes of the neighbor and 2-hop neighbor sets
+     * after their tuples have been modified in place.
+     */
+    void ReindexNeighbors();
+
+    /**
+     * Gets the version of the neighbor and 2-hop neighbor sets.
+     *
+     * The version changes each time a tuple is added to or removed from these
+     * sets, or their addresses are modified, so that values derived from them
+     * can be cached.
+     *
+     * \returns The neighborhood version.
+     */
+    uint32_t GetNeighborhoodVersion() const
+    {
+        return m_neighborhoodVersion;
+    }
+
     /**
      * Finds a 2-hop neighbor tuple.
      * \param neighbor The neighbor main address.
@@ -231,23 +308,54 @@ class OlsrState
     // Duplicate
 
     /**
-     * Finds a duplicate tuple.
-     * \param address The duplicate tuple address.
-     * \param sequenceNumber The duplicate tuple sequence number.
-     * \returns The duplicate tuple, or a null pointer if no match.
+     * Checks whether a message has already been received.
+     * \param address The message originator address.
+     * \param sequenceNumber The message sequence number.
+     * \returns true if the message is in the duplicate set.
      */
-    DuplicateTuple* FindDuplicateTuple(const Ipv4Address& address, uint16_t sequenceNumber);
-
+    bool IsDuplicate(const Ipv4Address& address, uint16_t sequenceNumber) const;
     /**
-     * Erases a duplicate tuple.
-     * \param tuple The tuple to erase.
+     * Checks whether a message has already been received on an interface.
+     * \param address The message originator address.
+     * \param sequenceNumber The message sequence number.
+     * \param iface The interface index.
+     * \returns true if the message is in the duplicate set for this interface.
      */
-    void EraseDuplicateTuple(const DuplicateTuple& tuple);
+    bool IsDuplicateOnInterface(const Ipv4Address& address,
+                                uint16_t sequenceNumber,
+                                uint32_t iface) const;
     /**
-     * Inserts a duplicate tuple.
-     * \param tuple The tuple to insert.
+     * Checks whether a message in the duplicate set has been retransmitted.
+     * \param address The message originator address.
+     * \param sequenceNumber The message sequence number.
+     * \returns true if the message has been retransmitted.
+     */
+    bool IsRetransmitted(const Ipv4Address& address, uint16_t sequenceNumber) const;
+    /**
+     * Records a message in the duplicate set, or updates its record.
+     * \param address The message originator address.
+     * \param sequenceNumber The message sequence number.
+     * \param iface The index of the interface the message was received on.
+     * \param retransmitted Whether the message has been retransmitted.
+     * \param expirationTime The time the record expires.
+     * \returns true if this is the first message recorded for the originator.
+     */
+    bool InsertDuplicate(const Ipv4Address& address,
+                         uint16_t sequenceNumber,
+                         uint32_t iface,
+                         bool retransmitted,
+                         Time expirationTime);
+    /**
+     * Finds the duplicate window of an originator.
+     * \param address The originator address.
+     * \returns The duplicate window, or a null pointer if no match.
      */
-    void InsertDuplicateTuple(const DuplicateTuple& tuple);
+    const DuplicateWindow* FindDuplicateWindow(const Ipv4Address& address) const;
+    /**
+     * Erases the duplicate window of an originator.
+     * \param address The originator address.
+     */
+    void EraseDuplicateWindow(const Ipv4Address& address);
 
     // Link
 
@@ -296,6 +404,18 @@ class OlsrState
         return m_topologySet;
     }
 
+    /**
+     * Gets the topology set.
+     *
+     * The destination and last hop addresses must not be modified through this reference.
+     *
+     * \returns The topology set.
+     */
+    TopologySet& GetTopologySet()
+    {
+        return m_topologySet;
+    }
+
     /**
      * Finds a topology tuple.
      * \param destAddr The destination address.
@@ -321,6 +441,14 @@ class OlsrState
      * \param ansn The Advertised Neighbor Sequence Number.
      */
     void EraseOlderTopologyTuples(const Ipv4Address& lastAddr, uint16_t ansn);
+    /**
+     * Erases the topology tuples of a last hop towards some destinations, in a single pass.
+     * \param lastAddr The last hop address.
+     * \param destAddrs The destination addresses.
+     * \returns The number of erased tuples.
+     */
+    uint32_t EraseTopologyTuples(const Ipv4Address& lastAddr,
+                                 const std::vector<Ipv4Address>& destAddrs);
     /**
      * Inserts a topology tuple.
      * \param tuple The tuple to insert.
@@ -340,6 +468,10 @@ class OlsrState
 
     /**
      * Gets a mutable reference to the interface association set.
+     *
+     * Only the tuple expiration times may be modified through this reference;
+     * the interface addresses are used as lookup keys.
+     *
      * \returns The interface association set.
      */
     IfaceAssocSet& GetIfaceAssocSetMutable()
@@ -427,6 +559,115 @@ class OlsrState
      * \returns A container of the neighbor addresses (excluding the main one).
      */
     std::vector<Ipv4Address> FindNeighborInterfaces(const Ipv4Address& neighborMainAddr) const;
+
+    // Node positions
+
+    /**
+     * Records the position advertised by a node.
+     *
+     * The expiration time of a known position is extended, never shortened. A position
+     * sampled before the known one, e.g. carried by a late forwarded message, is ignored.
+     *
+     * \param mainAddr The node main address.
+     * \param position The advertised position.
+     * \param velocity The advertised velocity.
+     * \param updateTime The sampling time of the position.
+     * \param expirationTime The time the position expires.
+     * \returns true if the position was unknown or has changed.
+     */
+    bool UpdateNodePosition(const Ipv4Address& mainAddr,
+                            const Vector& position,
+                            const Vector& velocity,
+                            Time updateTime,
+                            Time expirationTime);
+    /**
+     * Extends the validity of a known node position without changing it.
+     * \param mainAddr The node main address.
+     * \param expirationTime The time the position expires.
+     * \returns false if the position is unknown.
+     */
+    bool RefreshNodePosition(const Ipv4Address& mainAddr, Time expirationTime);
+    /**
+     * Finds the position of a node.
+     * \param mainAddr The node main address.
+     * \returns The index of the node position, or -1 if the position is unknown.
+     *
+     * The index stays valid until a node position is erased.
+     */
+    int32_t FindNodePosition(const Ipv4Address& mainAddr) const;
+    /**
+     * Gets a node position, as advertised.
+     * \param index The index of the node position.
+     * \returns The node position.
+     */
+    Vector GetNodePosition(uint32_t index) const
+    {
+        return Vector(m_nodePositionX[index], m_nodePositionY[index], m_nodePositionZ[index]);
+    }
+
+    /**
+     * Gets a node position, extrapolated from the advertised position and velocity.
+     * \param index The index of the node position.
+     * \param now The time to extrapolate the position to.
+     * \returns The estimated node position.
+     */
+    Vector GetNodePosition(uint32_t index, Time now) const
+    {
+        double dt = (now - m_nodePositionUpdateTime[index]).GetSeconds();
+        return Vector(m_nodePositionX[index] + m_nodeVelocityX[index] * dt,
+                      m_nodePositionY[index] + m_nodeVelocityY[index] * dt,
+                      m_nodePositionZ[index] + m_nodeVelocityZ[index] * dt);
+    }
+
+    /**
+     * Gets a node velocity.
+     * \param index The index of the node position.
+     * \returns The advertised node velocity.
+     */
+    Vector GetNodeVelocity(uint32_t index) const
+    {
+        return Vector(m_nodeVelocityX[index], m_nodeVelocityY[index], m_nodeVelocityZ[index]);
+    }
+
+    /**
+     * Gets the sampling time of a node position.
+     * \param index The index of the node position.
+     * \returns The time the position was sampled at.
+     */
+    Time GetNodePositionUpdateTime(uint32_t index) const
+    {
+        return m_nodePositionUpdateTime[index];
+    }
+
+    /**
+     * Gets the expiration time of a node position.
+     * \param index The index of the node position.
+     * \returns The time the position expires.
+     */
+    Time GetNodePositionExpirationTime(uint32_t index) const
+    {
+        return m_nodePositionExpirationTime[index];
+    }
+
+    /**
+     * Gets the number of known node positions.
+     * \returns The number of known node positions.
+     */
+    uint32_t GetNNodePositions() const
+    {
+        return m_nodePositionAddr.size();
+    }
+
+    /**
+     * Erases the position of a node.
+     * \param mainAddr The node main address.
+     */
+    void EraseNodePosition(const Ipv4Address& mainAddr);
+    /**
+     * Gets the highest speed of the known node positions.
+     * \returns The highest advertised speed, in m/s.
+     */
+    double GetMaxNodeSpeed() const;
 };
 
 } // namespace olsr
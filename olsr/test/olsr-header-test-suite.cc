@@ -193,6 +193,9 @@ OlsrHelloTestCase::DoRun()
 
     helloIn.SetHTime(Seconds(7));
     helloIn.willingness = olsr::Willingness::HIGH;
+    helloIn.positionInfo.SetPosition(Vector(1250.26, 3.04, 45), Vector(100, 0, 0), 0.1);
+    helloIn.positionInfo.SetTime(Seconds(70.25));
+    helloIn.positionInfo.SetVelocity(Vector(12.34, -3.21, 0));
 
     {
         olsr::MessageHeader::Hello::LinkMessage lm1;
@@ -209,12 +212,28 @@ OlsrHelloTestCase::DoRun()
     }
 
     packet.AddHeader(msgIn);
+    NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 12 + 4 + 16 + 2 * (4 + 2 * 4), "Wrong HELLO size");
 
     olsr::MessageHeader msgOut;
     packet.RemoveHeader(msgOut);
     olsr::MessageHeader::Hello& helloOut = msgOut.GetHello();
 
     NS_TEST_ASSERT_MSG_EQ(helloOut.GetHTime(), Seconds(7), "300");
+    Vector position = helloOut.positionInfo.GetPosition(Vector(100, 0, 0), 0.1);
+    NS_TEST_ASSERT_MSG_EQ_TOL(position.x, 1250.3, 1e-6, "Wrong HELLO position x");
+    NS_TEST_ASSERT_MSG_EQ_TOL(position.y, 3.0, 1e-6, "Wrong HELLO position y");
+    NS_TEST_ASSERT_MSG_EQ_TOL(position.z, 45.0, 1e-6, "Wrong HELLO position z");
+    NS_TEST_ASSERT_MSG_EQ(helloOut.positionInfo.GetTime(Seconds(70.5)),
+                          Seconds(70.25),
+                          "Wrong HELLO position time");
+    // The time is carried modulo 65.536 seconds
+    NS_TEST_ASSERT_MSG_EQ(helloOut.positionInfo.GetTime(Seconds(131.7)),
+                          Seconds(70.25),
+                          "Wrong HELLO position time across the wrap-around");
+    Vector velocity = helloOut.positionInfo.GetVelocity();
+    NS_TEST_ASSERT_MSG_EQ_TOL(velocity.x, 12.34, 1e-6, "Wrong HELLO velocity x");
+    NS_TEST_ASSERT_MSG_EQ_TOL(velocity.y, -3.21, 1e-6, "Wrong HELLO velocity y");
+    NS_TEST_ASSERT_MSG_EQ_TOL(velocity.z, 0.0, 1e-6, "Wrong HELLO velocity z");
     NS_TEST_ASSERT_MSG_EQ(helloOut.willingness, olsr::Willingness::HIGH, "301");
     NS_TEST_ASSERT_MSG_EQ(helloOut.linkMessages.size(), 2, "302");
 
@@ -235,6 +254,15 @@ OlsrHelloTestCase::DoRun()
                           "308");
 
     NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 0, "All bytes in packet were not read");
+
+    // A message too short for the position words it flags is rejected
+    Buffer buffer;
+    buffer.AddAtStart(helloIn.GetSerializedSize());
+    helloIn.Serialize(buffer.Begin());
+    olsr::MessageHeader::Hello truncated;
+    NS_TEST_ASSERT_MSG_EQ(truncated.Deserialize(buffer.Begin(), 4 + 8),
+                          0,
+                          "Truncated HELLO accepted");
 }
 
 /**
@@ -265,7 +293,11 @@ OlsrTcTestCase::DoRun()
     tcIn.ansn = 0x1234;
     tcIn.neighborAddresses.emplace_back("1.2.3.4");
     tcIn.neighborAddresses.emplace_back("1.2.3.5");
+    tcIn.positionInfo.SetPosition(Vector(-5, 7000, 30.01), Vector(0, 0, 0), 0.1);
+    tcIn.positionInfo.SetTime(Seconds(2));
+    tcIn.SetHelloInterval(Seconds(0.5));
     packet.AddHeader(msgIn);
+    NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 12 + 4 + 8 + 2 * 4, "Wrong TC size");
 
     olsr::MessageHeader msgOut;
     packet.RemoveHeader(msgOut);
@@ -277,7 +309,52 @@ OlsrTcTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(tcOut.neighborAddresses[0], Ipv4Address("1.2.3.4"), "402");
     NS_TEST_ASSERT_MSG_EQ(tcOut.neighborAddresses[1], Ipv4Address("1.2.3.5"), "403");
 
+    NS_TEST_ASSERT_MSG_EQ(tcOut.positionInfo.HasVelocity(), false, "Unexpected TC velocity");
+
+    // Coordinates outside of the encoded area are clamped to its borders
+    Vector position = tcOut.positionInfo.GetPosition(Vector(0, 0, 0), 0.1);
+    NS_TEST_ASSERT_MSG_EQ_TOL(position.x, 0.0, 1e-6, "Wrong TC position x");
+    NS_TEST_ASSERT_MSG_EQ_TOL(position.y, 6553.5, 1e-6, "Wrong TC position y");
+    NS_TEST_ASSERT_MSG_EQ_TOL(position.z, 30.0, 1e-6, "Wrong TC position z");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.positionInfo.GetTime(Seconds(2.1)),
+                          Seconds(2),
+                          "Wrong TC position time");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.GetHelloInterval(), Seconds(0.5), "Wrong TC hello interval");
+
     NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 0, "404");
+
+    // A message too short for the position words it flags is rejected
+    Buffer buffer;
+    buffer.AddAtStart(tcIn.GetSerializedSize());
+    tcIn.Serialize(buffer.Begin());
+    olsr::MessageHeader::Tc truncated;
+    NS_TEST_ASSERT_MSG_EQ(truncated.Deserialize(buffer.Begin(), 4 + 4), 0, "Truncated TC accepted");
+
+    // Differential TC message
+    olsr::MessageHeader deltaIn;
+    olsr::MessageHeader::Tc& tcDeltaIn = deltaIn.GetTc();
+    tcDeltaIn.ansn = 0x1235;
+    tcDeltaIn.delta = true;
+    tcDeltaIn.baseAnsn = 0x1234;
+    tcDeltaIn.neighborAddresses.emplace_back("1.2.3.6");
+    tcDeltaIn.removedAddresses.emplace_back("1.2.3.4");
+    tcDeltaIn.removedAddresses.emplace_back("1.2.3.5");
+    tcDeltaIn.SetHelloInterval(Seconds(0.5));
+    packet.AddHeader(deltaIn);
+    NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 12 + 4 + 4 + 3 * 4, "Wrong differential TC size");
+
+    olsr::MessageHeader deltaOut;
+    packet.RemoveHeader(deltaOut);
+    olsr::MessageHeader::Tc& tcDeltaOut = deltaOut.GetTc();
+
+    NS_TEST_ASSERT_MSG_EQ(tcDeltaOut.delta, true, "Differential TC not flagged");
+    NS_TEST_ASSERT_MSG_EQ(tcDeltaOut.positionInfo.flags, 0, "Wrong differential TC position flags");
+    NS_TEST_ASSERT_MSG_EQ(tcDeltaOut.baseAnsn, 0x1234, "Wrong base ANSN");
+    NS_TEST_ASSERT_MSG_EQ(tcDeltaOut.neighborAddresses.size(), 1, "Wrong number of added");
+    NS_TEST_ASSERT_MSG_EQ(tcDeltaOut.neighborAddresses[0], Ipv4Address("1.2.3.6"), "Wrong added");
+    NS_TEST_ASSERT_MSG_EQ(tcDeltaOut.removedAddresses.size(), 2, "Wrong number of removed");
+    NS_TEST_ASSERT_MSG_EQ(tcDeltaOut.removedAddresses[1], Ipv4Address("1.2.3.5"), "Wrong removed");
+    NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 0, "All bytes in packet were not read");
 }
 
 /**
@@ -326,6 +403,82 @@ OlsrHnaTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 0, "All bytes in packet were not read");
 }
 
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Check views over received olsr messages
+ */
+class OlsrMessageViewTestCase : public TestCase
+{
+  public:
+    OlsrMessageViewTestCase();
+    void DoRun() override;
+};
+
+OlsrMessageViewTestCase::OlsrMessageViewTestCase()
+    : TestCase("Check views over received olsr messages")
+{
+}
+
+void
+OlsrMessageViewTestCase::DoRun()
+{
+    Ptr<Packet> packet = Create<Packet>();
+    olsr::MessageHeader msgIn;
+    msgIn.GetMid().interfaceAddresses.emplace_back("1.2.3.4");
+    msgIn.SetOriginatorAddress(Ipv4Address("11.22.33.44"));
+    msgIn.SetTimeToLive(255);
+    msgIn.SetHopCount(1);
+    msgIn.SetMessageSequenceNumber(0x1234);
+    packet->AddHeader(msgIn);
+
+    // The message is surrounded by 3 other bytes on each side
+    uint8_t padding[3] = {};
+    packet->AddAtEnd(Create<Packet>(padding, 3));
+    Ptr<Packet> received = Create<Packet>(padding, 3);
+    received->AddAtEnd(packet);
+
+    uint8_t header[olsr::MessageView::HEADER_SIZE];
+    packet->CopyData(header, olsr::MessageView::HEADER_SIZE);
+
+    olsr::MessageView view;
+    NS_TEST_ASSERT_MSG_EQ(view.Parse(received, 3, header, packet->GetSize()),
+                          16,
+                          "Wrong message size");
+    NS_TEST_ASSERT_MSG_EQ(view.GetMessageType(), olsr::MessageHeader::MID_MESSAGE, "Wrong type");
+    NS_TEST_ASSERT_MSG_EQ(view.GetOriginatorAddress(), Ipv4Address("11.22.33.44"), "Wrong orig");
+    NS_TEST_ASSERT_MSG_EQ(view.GetMessageSequenceNumber(), 0x1234, "Wrong sequence number");
+
+    // Forwarding changes the fixed header fields, not the received packet
+    view.PrepareForward();
+    NS_TEST_ASSERT_MSG_EQ(view.GetTimeToLive(), 254, "Time to live not decreased");
+    NS_TEST_ASSERT_MSG_EQ(view.GetHopCount(), 2, "Hop count not increased");
+    uint8_t receivedHeader[olsr::MessageView::HEADER_SIZE + 3];
+    received->CopyData(receivedHeader, sizeof(receivedHeader));
+    NS_TEST_ASSERT_MSG_EQ(receivedHeader[3 + 8], 255, "Received packet modified");
+
+    olsr::MessageHeader msgOut;
+    view.CreateForwardedMessage()->RemoveHeader(msgOut);
+    NS_TEST_ASSERT_MSG_EQ(msgOut.GetTimeToLive(), 254, "Wrong forwarded time to live");
+    NS_TEST_ASSERT_MSG_EQ(msgOut.GetHopCount(), 2, "Wrong forwarded hop count");
+    NS_TEST_ASSERT_MSG_EQ(msgOut.GetMid().interfaceAddresses.size(), 1, "Wrong forwarded MID");
+
+    msgOut = olsr::MessageHeader();
+    view.Materialize(msgOut);
+    NS_TEST_ASSERT_MSG_EQ(msgOut.GetTimeToLive(), 254, "Wrong materialized time to live");
+    NS_TEST_ASSERT_MSG_EQ(msgOut.GetMid().interfaceAddresses.size(), 1, "Wrong MID payload");
+    NS_TEST_ASSERT_MSG_EQ(msgOut.GetMid().interfaceAddresses[0],
+                          Ipv4Address("1.2.3.4"),
+                          "Wrong MID address");
+
+    // Truncated messages are rejected
+    olsr::MessageView truncated;
+    NS_TEST_ASSERT_MSG_EQ(truncated.Parse(received, 3, header, 15),
+                          0,
+                          "Truncated message accepted");
+}
+
 /**
  * \ingroup olsr-test
  * \ingroup tests
@@ -346,6 +499,7 @@ OlsrTestSuite::OlsrTestSuite()
     AddTestCase(new OlsrHelloTestCase(), TestCase::QUICK);
     AddTestCase(new OlsrMidTestCase(), TestCase::QUICK);
     AddTestCase(new OlsrEmfTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrMessageViewTestCase(), TestCase::QUICK);
 }
 
 static OlsrTestSuite g_olsrTestSuite; //!< Static variable for test initialization
@@ -19,9 +19,12 @@
  *          Gustavo J. A. M. Carneiro <gjc@inescporto.pt>
  */
 
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/olsr-repositories.h"
 #include "ns3/olsr-routing-protocol.h"
+#include "ns3/simulator.h"
 #include "ns3/test.h"
 
 /**
@@ -172,6 +175,1072 @@ OlsrMprTestCase::DoRun()
     NS_TEST_EXPECT_MSG_EQ((mpr.find("10.0.0.9") == mpr.end()),
                           true,
                           "Node 1 must NOT select node 8 as MPR");
+    /*
+     * Node 1 gets three more neighbors 10.0.1.1, 10.0.1.2 and 10.0.1.3 and the
+     * 2-hop neighbors 10.0.2.1 to 10.0.2.80:
+     *   - 10.0.1.1 reaches all of them,
+     *   - 10.0.1.2 reaches 10.0.2.1 to 10.0.2.40,
+     *   - 10.0.1.3 reaches 10.0.2.41 to 10.0.2.80.
+     *
+     * No 2-hop neighbor is reachable through a single neighbor, so node 1 must
+     * select node 10.0.1.1 (highest reachability) in addition to nodes 2, 3 and 7.
+     */
+    neighbor.willingness = Willingness::DEFAULT;
+    neighbor.neighborMainAddr = Ipv4Address("10.0.1.1");
+    protocol->m_state.InsertNeighborTuple(neighbor);
+    neighbor.neighborMainAddr = Ipv4Address("10.0.1.2");
+    protocol->m_state.InsertNeighborTuple(neighbor);
+    neighbor.neighborMainAddr = Ipv4Address("10.0.1.3");
+    protocol->m_state.InsertNeighborTuple(neighbor);
+    for (uint32_t i = 1; i <= 80; i++)
+    {
+        tuple.twoHopNeighborAddr = Ipv4Address(Ipv4Address("10.0.2.0").Get() + i);
+        tuple.neighborMainAddr = Ipv4Address("10.0.1.1");
+        protocol->m_state.InsertTwoHopNeighborTuple(tuple);
+        tuple.neighborMainAddr = Ipv4Address(i <= 40 ? "10.0.1.2" : "10.0.1.3");
+        protocol->m_state.InsertTwoHopNeighborTuple(tuple);
+    }
+
+    protocol->MprComputation();
+    mpr = state.GetMprSet();
+    NS_TEST_EXPECT_MSG_EQ(mpr.size(), 4, "Only one more MPR must be chosen.");
+    NS_TEST_EXPECT_MSG_EQ((mpr.find("10.0.1.1") != mpr.end()),
+                          true,
+                          "Node 1 must select node 10.0.1.1 as MPR");
+
+    // Nothing changed in the neighborhood: the MPR set is kept as is.
+    protocol->UpdateMprSet();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetSkippedMprComputations(),
+                          1,
+                          "MPR computation must be skipped if the neighborhood is unchanged.");
+    tuple.neighborMainAddr = Ipv4Address("10.0.1.2");
+    tuple.twoHopNeighborAddr = Ipv4Address("10.0.2.100");
+    protocol->m_state.InsertTwoHopNeighborTuple(tuple);
+    protocol->UpdateMprSet();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetSkippedMprComputations(),
+                          1,
+                          "MPR computation must not be skipped if the neighborhood changed.");
+    mpr = state.GetMprSet();
+    NS_TEST_EXPECT_MSG_EQ((mpr.find("10.0.1.2") != mpr.end()),
+                          true,
+                          "Node 1 must select node 10.0.1.2 as MPR");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the Duplicate Set
+ */
+class OlsrDuplicateSetTestCase : public TestCase
+{
+  public:
+    OlsrDuplicateSetTestCase();
+    void DoRun() override;
+};
+
+OlsrDuplicateSetTestCase::OlsrDuplicateSetTestCase()
+    : TestCase("Check the OLSR Duplicate Set")
+{
+}
+
+void
+OlsrDuplicateSetTestCase::DoRun()
+{
+    OlsrState state;
+    Ipv4Address originator("10.0.0.1");
+    Time expiration = Seconds(30);
+
+    NS_TEST_EXPECT_MSG_EQ(state.InsertDuplicate(originator, 65530, 1, true, expiration),
+                          true,
+                          "The first message of an originator creates its window");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 65530), true, "Recorded message");
+    NS_TEST_EXPECT_MSG_EQ(state.IsRetransmitted(originator, 65530), true, "Retransmitted flag");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicateOnInterface(originator, 65530, 1),
+                          true,
+                          "Message received on interface 1");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicateOnInterface(originator, 65530, 2),
+                          false,
+                          "Message not received on interface 2");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 65531), false, "Unknown message");
+
+    // Sequence numbers wrap around
+    NS_TEST_EXPECT_MSG_EQ(state.InsertDuplicate(originator, 3, 1, false, expiration),
+                          false,
+                          "The window of the originator already exists");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 3), true, "Message after wrap around");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 65530), true, "Message before wrap around");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 65535), false, "Skipped message");
+    NS_TEST_EXPECT_MSG_EQ(state.IsRetransmitted(originator, 3), false, "Retransmitted flag");
+
+    // Messages older than the window are duplicates, slots reused by newer ones are cleared
+    state.InsertDuplicate(originator, 3 + DuplicateWindow::WINDOW_SIZE, 1, false, expiration);
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 3), true, "Message older than the window");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 4 + DuplicateWindow::WINDOW_SIZE),
+                          false,
+                          "Message newer than the window");
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 4), false, "Slot of a skipped message");
+
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(Ipv4Address("10.0.0.2"), 3), false, "Other originator");
+    state.EraseDuplicateWindow(originator);
+    NS_TEST_EXPECT_MSG_EQ(state.IsDuplicate(originator, 3 + DuplicateWindow::WINDOW_SIZE),
+                          false,
+                          "Erased window");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the OLSR routing table
+ */
+class OlsrRoutingTableTestCase : public TestCase
+{
+  public:
+    OlsrRoutingTableTestCase();
+    void DoRun() override;
+};
+
+OlsrRoutingTableTestCase::OlsrRoutingTableTestCase()
+    : TestCase("Check the OLSR routing table")
+{
+}
+
+void
+OlsrRoutingTableTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    Ipv4Address a("10.0.0.1");
+    Ipv4Address b("10.0.0.2");
+    Ipv4Address c("10.0.0.3");
+    Ipv4Address d("10.0.0.4");
+
+    // Next hops that are not neighbors are resolved when the entry is added
+    protocol->AddEntry(a, a, 1, 1);
+    protocol->AddEntry(b, a, 2, 2);
+    protocol->AddEntry(c, b, 3, 3);
+    NS_TEST_ASSERT_MSG_EQ(protocol->GetSize(), 3, "Three routes");
+    const RoutingTableEntry* entry = protocol->Lookup(c);
+    NS_TEST_ASSERT_MSG_NE(entry, nullptr, "Route to C");
+    NS_TEST_EXPECT_MSG_EQ(entry->nextAddr, a, "C is reached through neighbor A");
+    NS_TEST_EXPECT_MSG_EQ(entry->interface, 1, "C is reached on the interface of A");
+    NS_TEST_EXPECT_MSG_EQ(entry->distance, 3, "Distance to C");
+    NS_TEST_EXPECT_MSG_EQ(protocol->Lookup(d), nullptr, "No route to D");
+
+    // Adding a route again overwrites it
+    protocol->AddEntry(c, c, 2, 1);
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetSize(), 3, "Still three routes");
+    NS_TEST_EXPECT_MSG_EQ(protocol->Lookup(c)->nextAddr, c, "C became a neighbor");
+
+    // Removing an entry keeps the others reachable
+    protocol->RemoveEntry(a);
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetSize(), 2, "Two routes");
+    NS_TEST_EXPECT_MSG_EQ(protocol->Lookup(a), nullptr, "Route to A removed");
+    NS_TEST_EXPECT_MSG_EQ(protocol->Lookup(b)->distance, 2, "Route to B kept");
+    NS_TEST_EXPECT_MSG_EQ(protocol->Lookup(c)->distance, 1, "Route to C kept");
+
+    std::vector<RoutingTableEntry> entries = protocol->GetRoutingTableEntries();
+    NS_TEST_ASSERT_MSG_EQ(entries.size(), 2, "Two entries");
+    NS_TEST_EXPECT_MSG_EQ(entries[0].destAddr, b, "Entries sorted by destination");
+    NS_TEST_EXPECT_MSG_EQ(entries[1].destAddr, c, "Entries sorted by destination");
+
+    protocol->Clear();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetSize(), 0, "Empty table");
+    NS_TEST_EXPECT_MSG_EQ(protocol->Lookup(b), nullptr, "Route to B cleared");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the longest prefix matching of the HNA routes
+ */
+class OlsrHnaRoutingTableTestCase : public TestCase
+{
+  public:
+    OlsrHnaRoutingTableTestCase();
+    void DoRun() override;
+};
+
+OlsrHnaRoutingTableTestCase::OlsrHnaRoutingTableTestCase()
+    : TestCase("Check the OLSR HNA routing table")
+{
+}
+
+void
+OlsrHnaRoutingTableTestCase::DoRun()
+{
+    HnaRoutingTable table;
+    HnaRoute route;
+    route.interface = 1;
+
+    route.networkAddr = Ipv4Address("10.0.0.0");
+    route.netmask = Ipv4Mask("255.0.0.0");
+    route.nextAddr = Ipv4Address("192.168.0.1");
+    route.distance = 3;
+    NS_TEST_EXPECT_MSG_EQ(table.AddRoute(route), true, "Route to 10.0.0.0/8");
+    route.networkAddr = Ipv4Address("10.1.0.0");
+    route.netmask = Ipv4Mask("255.255.0.0");
+    route.nextAddr = Ipv4Address("192.168.0.2");
+    route.distance = 2;
+    NS_TEST_EXPECT_MSG_EQ(table.AddRoute(route), true, "Route to 10.1.0.0/16");
+
+    const HnaRoute* found = table.Lookup(Ipv4Address("10.1.2.3"));
+    NS_TEST_ASSERT_MSG_NE(found, nullptr, "Route to 10.1.2.3");
+    NS_TEST_EXPECT_MSG_EQ(found->nextAddr, Ipv4Address("192.168.0.2"), "Longest prefix");
+    found = table.Lookup(Ipv4Address("10.2.0.1"));
+    NS_TEST_ASSERT_MSG_NE(found, nullptr, "Route to 10.2.0.1");
+    NS_TEST_EXPECT_MSG_EQ(found->nextAddr, Ipv4Address("192.168.0.1"), "Shorter prefix");
+    NS_TEST_EXPECT_MSG_EQ(table.Lookup(Ipv4Address("11.0.0.1")), nullptr, "No route");
+
+    // Only a closer gateway replaces the route to a network
+    route.networkAddr = Ipv4Address("10.0.0.0");
+    route.netmask = Ipv4Mask("255.0.0.0");
+    route.nextAddr = Ipv4Address("192.168.0.3");
+    route.distance = 3;
+    NS_TEST_EXPECT_MSG_EQ(table.AddRoute(route), false, "Gateway at the same distance");
+    route.distance = 1;
+    NS_TEST_EXPECT_MSG_EQ(table.AddRoute(route), true, "Closer gateway");
+    NS_TEST_EXPECT_MSG_EQ(table.GetNRoutes(), 2, "Two routes");
+    found = table.FindRoute(Ipv4Address("10.0.0.0"), Ipv4Mask("255.0.0.0"));
+    NS_TEST_ASSERT_MSG_NE(found, nullptr, "Route to 10.0.0.0/8");
+    NS_TEST_EXPECT_MSG_EQ(found->nextAddr, Ipv4Address("192.168.0.3"), "Replaced route");
+    NS_TEST_EXPECT_MSG_EQ(table.FindRoute(Ipv4Address("10.0.0.0"), Ipv4Mask("255.255.0.0")),
+                          nullptr,
+                          "No route to 10.0.0.0/16");
+
+    // A default route matches everything else
+    route.networkAddr = Ipv4Address("0.0.0.0");
+    route.netmask = Ipv4Mask("0.0.0.0");
+    route.nextAddr = Ipv4Address("192.168.0.4");
+    table.AddRoute(route);
+    found = table.Lookup(Ipv4Address("11.0.0.1"));
+    NS_TEST_ASSERT_MSG_NE(found, nullptr, "Default route");
+    NS_TEST_EXPECT_MSG_EQ(found->nextAddr, Ipv4Address("192.168.0.4"), "Default route");
+
+    // Swapping exchanges the whole tables
+    HnaRoutingTable other;
+    other.Swap(table);
+    NS_TEST_EXPECT_MSG_EQ(table.GetNRoutes(), 0, "Swapped with an empty table");
+    NS_TEST_EXPECT_MSG_EQ(other.GetNRoutes(), 3, "Swapped routes");
+    NS_TEST_EXPECT_MSG_EQ(other.Lookup(Ipv4Address("10.1.2.3"))->nextAddr,
+                          Ipv4Address("192.168.0.2"),
+                          "Swapped trie");
+
+    other.Clear();
+    NS_TEST_EXPECT_MSG_EQ(other.GetNRoutes(), 0, "Empty table");
+    NS_TEST_EXPECT_MSG_EQ(other.Lookup(Ipv4Address("10.1.2.3")), nullptr, "Cleared route");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the neighbors advertised in TC messages and their scope
+ */
+class OlsrTcScopeTestCase : public TestCase
+{
+  public:
+    OlsrTcScopeTestCase();
+    void DoRun() override;
+};
+
+OlsrTcScopeTestCase::OlsrTcScopeTestCase()
+    : TestCase("Check the neighbors advertised in OLSR TC messages and their scope")
+{
+}
+
+void
+OlsrTcScopeTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    OlsrState& state = protocol->m_state;
+
+    // Node 2 selected node 1 as MPR, which selected node 3; node 4 is a symmetric neighbor too
+    NeighborTuple neighbor;
+    neighbor.status = NeighborTuple::STATUS_SYM;
+    neighbor.willingness = Willingness::DEFAULT;
+    for (const char* address : {"10.0.0.2", "10.0.0.3", "10.0.0.4"})
+    {
+        neighbor.neighborMainAddr = Ipv4Address(address);
+        state.InsertNeighborTuple(neighbor);
+    }
+    neighbor.status = NeighborTuple::STATUS_NOT_SYM;
+    neighbor.neighborMainAddr = Ipv4Address("10.0.0.5");
+    state.InsertNeighborTuple(neighbor);
+    MprSelectorTuple mprSelector;
+    mprSelector.mainAddr = Ipv4Address("10.0.0.2");
+    mprSelector.expirationTime = Seconds(3600);
+    state.InsertMprSelectorTuple(mprSelector);
+    MprSet mprSet;
+    mprSet.insert(Ipv4Address("10.0.0.3"));
+    state.SetMprSet(mprSet);
+
+    std::vector<Ipv4Address> advertised = protocol->GetAdvertisedNeighbors();
+    NS_TEST_EXPECT_MSG_EQ(advertised.size(), 1, "Only the MPR selectors are advertised");
+    NS_TEST_EXPECT_MSG_EQ(advertised[0], Ipv4Address("10.0.0.2"), "MPR selector");
+
+    protocol->m_tcRedundancy = RoutingProtocol::MPR_SELECTORS_AND_MPRS;
+    advertised = protocol->GetAdvertisedNeighbors();
+    NS_TEST_EXPECT_MSG_EQ(advertised.size(), 2, "The MPR selectors and MPRs are advertised");
+    NS_TEST_EXPECT_MSG_EQ(advertised[1], Ipv4Address("10.0.0.3"), "MPR");
+
+    protocol->m_tcRedundancy = RoutingProtocol::ALL_NEIGHBORS;
+    advertised = protocol->GetAdvertisedNeighbors();
+    NS_TEST_EXPECT_MSG_EQ(advertised.size(), 3, "All the symmetric neighbors are advertised");
+
+    // A neighbor losing symmetry is no longer advertised, under a new ANSN
+    olsr::MessageHeader::Tc tc;
+    protocol->FillTcNeighbors(tc, advertised, 255);
+    uint16_t ansn = tc.ansn;
+    state.FindNeighborTuple(Ipv4Address("10.0.0.4"))->status = NeighborTuple::STATUS_NOT_SYM;
+    tc = olsr::MessageHeader::Tc();
+    protocol->FillTcNeighbors(tc, protocol->GetAdvertisedNeighbors(), 255);
+    NS_TEST_EXPECT_MSG_EQ(tc.neighborAddresses.size(), 2, "Only the symmetric neighbors");
+    NS_TEST_EXPECT_MSG_NE(tc.ansn, ansn, "New ANSN for the smaller neighbor set");
+    ansn = tc.ansn;
+    tc = olsr::MessageHeader::Tc();
+    protocol->FillTcNeighbors(tc, protocol->GetAdvertisedNeighbors(), 255);
+    NS_TEST_EXPECT_MSG_EQ(tc.ansn, ansn, "Same ANSN for the same neighbor set");
+
+    // Without fisheye, every TC message floods the whole network
+    uint32_t period;
+    NS_TEST_EXPECT_MSG_EQ(+protocol->GetNextTcTtl(period), 255, "Default TTL");
+    NS_TEST_EXPECT_MSG_EQ(period, 1, "Default period");
+
+    // With fisheye, only one TC message out of three reaches beyond 4 hops
+    protocol->m_fisheyeTtls = {2, 4, 255};
+    uint32_t expectedPeriods[] = {1, 1, 3, 1};
+    uint8_t expectedTtls[] = {2, 4, 255, 2};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(+protocol->GetNextTcTtl(period), +expectedTtls[i], "Fisheye TTL");
+        NS_TEST_EXPECT_MSG_EQ(period, expectedPeriods[i], "Fisheye period");
+    }
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the differential TC messages
+ */
+class OlsrDifferentialTcTestCase : public TestCase
+{
+  public:
+    OlsrDifferentialTcTestCase();
+    void DoRun() override;
+};
+
+OlsrDifferentialTcTestCase::OlsrDifferentialTcTestCase()
+    : TestCase("Check the changes carried by differential OLSR TC messages")
+{
+}
+
+void
+OlsrDifferentialTcTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->m_differentialTc = true;
+    protocol->m_tcFullRefreshPeriod = 3;
+
+    std::vector<Ipv4Address> neighbors;
+    for (const char* address : {"10.0.0.2", "10.0.0.3", "10.0.0.4", "10.0.0.5", "10.0.0.6"})
+    {
+        neighbors.emplace_back(address);
+    }
+
+    // The first TC message is a full one, with a new ANSN
+    olsr::MessageHeader::Tc tc;
+    uint16_t ansn = protocol->m_ansn;
+    protocol->FillTcNeighbors(tc, neighbors, 255);
+    NS_TEST_EXPECT_MSG_EQ(tc.delta, false, "No previous TC message");
+    NS_TEST_EXPECT_MSG_EQ(tc.neighborAddresses.size(), 5, "All the neighbors");
+    NS_TEST_EXPECT_MSG_NE(protocol->m_ansn, ansn, "New ANSN");
+
+    // One neighbor replaced by another one
+    ansn = protocol->m_ansn;
+    neighbors[4] = Ipv4Address("10.0.0.7");
+    tc = olsr::MessageHeader::Tc();
+    protocol->FillTcNeighbors(tc, neighbors, 255);
+    NS_TEST_EXPECT_MSG_EQ(tc.delta, true, "Shorter differential TC");
+    NS_TEST_EXPECT_MSG_EQ(tc.baseAnsn, ansn, "Base ANSN");
+    NS_TEST_EXPECT_MSG_NE(protocol->m_ansn, ansn, "New ANSN");
+    NS_TEST_EXPECT_MSG_EQ(tc.neighborAddresses.size(), 1, "Added neighbor");
+    NS_TEST_EXPECT_MSG_EQ(tc.neighborAddresses[0], Ipv4Address("10.0.0.7"), "Added neighbor");
+    NS_TEST_EXPECT_MSG_EQ(tc.removedAddresses.size(), 1, "Removed neighbor");
+    NS_TEST_EXPECT_MSG_EQ(tc.removedAddresses[0], Ipv4Address("10.0.0.6"), "Removed neighbor");
+
+    // The nodes beyond the previous TTL did not get the previous TC message
+    tc = olsr::MessageHeader::Tc();
+    protocol->FillTcNeighbors(tc, neighbors, 2);
+    tc = olsr::MessageHeader::Tc();
+    protocol->FillTcNeighbors(tc, neighbors, 4);
+    NS_TEST_EXPECT_MSG_EQ(tc.delta, false, "TTL beyond the previous one");
+
+    // Unchanged neighbors keep the ANSN, until the periodic full TC message
+    ansn = protocol->m_ansn;
+    tc = olsr::MessageHeader::Tc();
+    protocol->FillTcNeighbors(tc, neighbors, 4);
+    NS_TEST_EXPECT_MSG_EQ(tc.delta, true, "Empty differential TC");
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_ansn, ansn, "Same ANSN");
+    tc = olsr::MessageHeader::Tc();
+    protocol->FillTcNeighbors(tc, neighbors, 4);
+    NS_TEST_EXPECT_MSG_EQ(tc.delta, true, "Empty differential TC");
+    tc = olsr::MessageHeader::Tc();
+    protocol->FillTcNeighbors(tc, neighbors, 4);
+    NS_TEST_EXPECT_MSG_EQ(tc.delta, false, "Periodic full TC");
+    NS_TEST_EXPECT_MSG_EQ(tc.neighborAddresses.size(), 5, "All the neighbors");
+
+    // Node 9 advertised nodes 2, 3 and 4 with ANSN 5
+    Ptr<RoutingProtocol> receiver = CreateObject<RoutingProtocol>();
+    receiver->m_mainAddress = Ipv4Address("10.0.0.1");
+    OlsrState& state = receiver->m_state;
+    TopologyTuple topologyTuple;
+    topologyTuple.lastAddr = Ipv4Address("10.0.0.9");
+    topologyTuple.sequenceNumber = 5;
+    topologyTuple.expirationTime = Seconds(1);
+    for (const char* address : {"10.0.0.2", "10.0.0.3", "10.0.0.4"})
+    {
+        topologyTuple.destAddr = Ipv4Address(address);
+        state.InsertTopologyTuple(topologyTuple);
+    }
+
+    // It then replaces node 3 by node 7
+    olsr::MessageHeader msg;
+    msg.SetOriginatorAddress(Ipv4Address("10.0.0.9"));
+    msg.SetVTime(Seconds(15));
+    olsr::MessageHeader::Tc& delta = msg.GetTc();
+    delta.delta = true;
+    delta.ansn = 6;
+    delta.baseAnsn = 4;
+    delta.neighborAddresses.emplace_back("10.0.0.7");
+    delta.removedAddresses.emplace_back("10.0.0.3");
+
+    // Changes to a topology other than the current one are ignored
+    receiver->ProcessTcDelta(msg);
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet().size(), 3, "Delta on another ANSN applied");
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet()[0].sequenceNumber, 5, "Tuple changed");
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet()[0].expirationTime, Seconds(1), "Tuple refreshed");
+
+    // So are changes to the topology of an unknown node
+    delta.baseAnsn = 5;
+    msg.SetOriginatorAddress(Ipv4Address("10.0.0.8"));
+    receiver->ProcessTcDelta(msg);
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet().size(), 3, "Delta of an unknown node applied");
+    NS_TEST_EXPECT_MSG_EQ(state.FindTopologyTuple(Ipv4Address("10.0.0.7"), Ipv4Address("10.0.0.8")),
+                          nullptr,
+                          "Tuple added for an unknown node");
+
+    msg.SetOriginatorAddress(Ipv4Address("10.0.0.9"));
+    receiver->ProcessTcDelta(msg);
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet().size(), 3, "Wrong number of tuples");
+    NS_TEST_EXPECT_MSG_EQ(state.FindTopologyTuple(Ipv4Address("10.0.0.3"), Ipv4Address("10.0.0.9")),
+                          nullptr,
+                          "Removed tuple kept");
+    for (const char* address : {"10.0.0.2", "10.0.0.4", "10.0.0.7"})
+    {
+        const TopologyTuple* tuple =
+            state.FindTopologyTuple(Ipv4Address(address), Ipv4Address("10.0.0.9"));
+        NS_TEST_ASSERT_MSG_NE(tuple, nullptr, "Missing tuple");
+        NS_TEST_EXPECT_MSG_EQ(tuple->sequenceNumber, 6, "Tuple not moved to the new ANSN");
+        NS_TEST_EXPECT_MSG_EQ(tuple->expirationTime, Seconds(15), "Tuple not refreshed");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the coalescing of the neighbor losses
+ */
+class OlsrExpiryCoalescingTestCase : public TestCase
+{
+  public:
+    OlsrExpiryCoalescingTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Counts the routing table computations.
+     * \param size The size of the routing table.
+     */
+    void RoutingTableChanged(uint32_t size);
+    /**
+     * Sums the computations saved by the expiry sweeps.
+     * \param saved The number of computations saved.
+     */
+    void RecomputationsSaved(uint32_t saved);
+
+    uint32_t m_computations; //!< Number of routing table computations.
+    uint32_t m_saved;        //!< Number of computations saved.
+};
+
+OlsrExpiryCoalescingTestCase::OlsrExpiryCoalescingTestCase()
+    : TestCase("Check that close OLSR neighbor losses share a single computation"),
+      m_computations(0),
+      m_saved(0)
+{
+}
+
+void
+OlsrExpiryCoalescingTestCase::RoutingTableChanged(uint32_t size)
+{
+    m_computations++;
+}
+
+void
+OlsrExpiryCoalescingTestCase::RecomputationsSaved(uint32_t saved)
+{
+    m_saved += saved;
+}
+
+void
+OlsrExpiryCoalescingTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->SetIpv4(node->GetObject<Ipv4>());
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    protocol->m_expiryCoalescingWindow = Seconds(1);
+    protocol->m_linkTupleTimerFirstTime = false;
+    protocol->m_routingTableChanged.ConnectWithoutContext(
+        MakeCallback(&OlsrExpiryCoalescingTestCase::RoutingTableChanged, this));
+    protocol->m_recomputationsSavedTrace.ConnectWithoutContext(
+        MakeCallback(&OlsrExpiryCoalescingTestCase::RecomputationsSaved, this));
+    OlsrState& state = protocol->m_state;
+
+    // The links to nodes 2, 3 and 4 stop being symmetric at 10, 10.2 and 10.4 s
+    LinkTuple link;
+    link.localIfaceAddr = Ipv4Address("10.0.0.1");
+    link.asymTime = Seconds(100);
+    link.time = Seconds(100);
+    NeighborTuple neighbor;
+    neighbor.status = NeighborTuple::STATUS_SYM;
+    neighbor.willingness = Willingness::DEFAULT;
+    Time symTime = Seconds(10);
+    for (const char* address : {"10.0.0.2", "10.0.0.3", "10.0.0.4"})
+    {
+        link.neighborIfaceAddr = Ipv4Address(address);
+        link.symTime = symTime;
+        state.InsertLinkTuple(link);
+        neighbor.neighborMainAddr = Ipv4Address(address);
+        state.InsertNeighborTuple(neighbor);
+        protocol->ScheduleExpiry(symTime,
+                                 RoutingProtocol::ExpiryKind::LINK,
+                                 link.generation,
+                                 Ipv4Address(address));
+        symTime += MilliSeconds(200);
+    }
+
+    // A topology tuple expires in between, at 10.1 s
+    TopologyTuple topologyTuple;
+    topologyTuple.destAddr = Ipv4Address("10.0.0.5");
+    topologyTuple.lastAddr = Ipv4Address("10.0.0.2");
+    topologyTuple.sequenceNumber = 1;
+    topologyTuple.expirationTime = Seconds(10.1);
+    state.InsertTopologyTuple(topologyTuple);
+    protocol->ScheduleExpiry(topologyTuple.expirationTime,
+                             RoutingProtocol::ExpiryKind::TOPOLOGY,
+                             topologyTuple.generation,
+                             topologyTuple.destAddr,
+                             topologyTuple.lastAddr);
+
+    // The tuples expire on time, only the computation waits for the window
+    Simulator::Stop(Seconds(10.5));
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet().size(), 0, "Topology tuple expiration delayed");
+    for (const char* address : {"10.0.0.2", "10.0.0.3", "10.0.0.4"})
+    {
+        NS_TEST_EXPECT_MSG_EQ(state.FindNeighborTuple(Ipv4Address(address))->status,
+                              NeighborTuple::STATUS_NOT_SYM,
+                              "Link expiration delayed");
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_computations, 0, "Routing table computed before the window");
+
+    // The three neighbor losses fall within the window of the first one
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(m_computations, 1, "Neighbor losses computed separately");
+    NS_TEST_EXPECT_MSG_EQ(m_saved, 2, "Saved computations");
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_coalescedRecomputations, 2, "Saved computations");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the expiry entries of the tuples added again under the same key
+ */
+class OlsrExpiryGenerationTestCase : public TestCase
+{
+  public:
+    OlsrExpiryGenerationTestCase();
+    void DoRun() override;
+};
+
+OlsrExpiryGenerationTestCase::OlsrExpiryGenerationTestCase()
+    : TestCase("Check that the OLSR expiry queue stays proportional to the live tuples")
+{
+}
+
+void
+OlsrExpiryGenerationTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->SetIpv4(node->GetObject<Ipv4>());
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+
+    // Node 2 is a symmetric neighbor
+    LinkTuple link;
+    link.localIfaceAddr = Ipv4Address("10.0.0.1");
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.2");
+    link.symTime = Seconds(1000);
+    link.asymTime = Seconds(1000);
+    link.time = Seconds(1000);
+    protocol->m_state.InsertLinkTuple(link);
+
+    // Every 5 s, node 2 advertises the same neighbors under a new ANSN, which replaces its
+    // topology tuples by new ones with the same keys
+    olsr::MessageHeader msg;
+    msg.SetOriginatorAddress(Ipv4Address("10.0.0.2"));
+    msg.SetVTime(Seconds(12));
+    olsr::MessageHeader::Tc& tc = msg.GetTc();
+    tc.neighborAddresses.emplace_back("10.0.0.3");
+    tc.neighborAddresses.emplace_back("10.0.0.4");
+    std::size_t queueSize = 0;
+    for (uint16_t ansn = 1; ansn <= 10; ansn++)
+    {
+        Simulator::Stop(Seconds(5));
+        Simulator::Run();
+        tc.ansn = ansn;
+        protocol->ProcessTc(msg, Ipv4Address("10.0.0.2"));
+        NS_TEST_ASSERT_MSG_EQ(protocol->m_state.GetTopologySet().size(), 2, "Topology tuples");
+
+        // Once the entries of the first tuples are due, the replaced tuples leave none behind
+        if (ansn == 4)
+        {
+            queueSize = protocol->m_expiryQueue.size();
+        }
+        else if (ansn > 4)
+        {
+            NS_TEST_EXPECT_MSG_EQ(protocol->m_expiryQueue.size(),
+                                  queueSize,
+                                  "Expiry entries of replaced tuples kept");
+        }
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the priorities of the outgoing message queue
+ */
+class OlsrMessageQueueTestCase : public TestCase
+{
+  public:
+    OlsrMessageQueueTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Records the messages of a sent packet.
+     * \param header The packet header.
+     * \param messages The messages of the packet.
+     */
+    void PacketSent(const PacketHeader& header, const MessageList& messages);
+
+    std::vector<MessageList> m_packets; //!< Messages of the sent packets.
+};
+
+OlsrMessageQueueTestCase::OlsrMessageQueueTestCase()
+    : TestCase("Check the deadline and order of the queued OLSR messages")
+{
+}
+
+void
+OlsrMessageQueueTestCase::PacketSent(const PacketHeader& header, const MessageList& messages)
+{
+    m_packets.push_back(messages);
+}
+
+void
+OlsrMessageQueueTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->SetIpv4(node->GetObject<Ipv4>());
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    protocol->m_forwardingHoldTime = Seconds(1);
+    protocol->m_txPacketTrace.ConnectWithoutContext(
+        MakeCallback(&OlsrMessageQueueTestCase::PacketSent, this));
+    OlsrState& state = protocol->m_state;
+
+    // Node 2 is a symmetric neighbor, which selected node 1 as MPR
+    LinkTuple link;
+    link.localIfaceAddr = Ipv4Address("10.0.0.1");
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.2");
+    link.symTime = Seconds(100);
+    link.asymTime = Seconds(100);
+    link.time = Seconds(100);
+    state.InsertLinkTuple(link);
+    MprSelectorTuple mprSelector;
+    mprSelector.mainAddr = Ipv4Address("10.0.0.2");
+    mprSelector.expirationTime = Seconds(100);
+    state.InsertMprSelectorTuple(mprSelector);
+
+    // A TC message of node 3 relayed by node 2 waits for the hold time
+    olsr::MessageHeader msg;
+    msg.GetTc().ansn = 1;
+    msg.SetOriginatorAddress(Ipv4Address("10.0.0.3"));
+    msg.SetVTime(Seconds(15));
+    msg.SetTimeToLive(255);
+    msg.SetMessageSequenceNumber(7);
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(msg);
+    uint8_t header[olsr::MessageView::HEADER_SIZE];
+    packet->CopyData(header, olsr::MessageView::HEADER_SIZE);
+    olsr::MessageView view;
+    view.Parse(packet, 0, header, packet->GetSize());
+    protocol->ForwardDefault(view, false, 0, Ipv4Address("10.0.0.2"));
+    NS_TEST_ASSERT_MSG_EQ(protocol->m_queuedMessages.size(), 1, "Message not forwarded");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(protocol->m_queuedMessagesDeadline,
+                                Seconds(1),
+                                "Forwarded message not held");
+
+    // An own message due earlier brings the flush forward
+    msg = olsr::MessageHeader();
+    msg.GetTc().ansn = 2;
+    msg.SetOriginatorAddress(Ipv4Address("10.0.0.1"));
+    msg.SetVTime(Seconds(15));
+    msg.SetTimeToLive(255);
+    msg.SetMessageSequenceNumber(1);
+    protocol->QueueMessage(msg, MilliSeconds(750));
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_queuedMessagesDeadline,
+                          MilliSeconds(750),
+                          "Flush not brought forward");
+
+    // So does a HELLO message queued last, which is not held either
+    protocol->SendHello();
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(protocol->m_queuedMessagesDeadline,
+                                protocol->m_helloInterval / 4,
+                                "HELLO message held");
+
+    // They all make it in the same packet, the HELLO message first and the forwarded one last
+    Simulator::Stop(MilliSeconds(600));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(m_packets.size(), 1, "Messages sent separately");
+    NS_TEST_ASSERT_MSG_EQ(m_packets[0].size(), 3, "Messages missing from the packet");
+    NS_TEST_EXPECT_MSG_EQ(m_packets[0][0].GetMessageType(),
+                          olsr::MessageHeader::HELLO_MESSAGE,
+                          "HELLO message not first");
+    NS_TEST_EXPECT_MSG_EQ(m_packets[0][1].GetOriginatorAddress(),
+                          Ipv4Address("10.0.0.1"),
+                          "Own message not second");
+    NS_TEST_EXPECT_MSG_EQ(m_packets[0][2].GetOriginatorAddress(),
+                          Ipv4Address("10.0.0.3"),
+                          "Forwarded message not last");
+    NS_TEST_EXPECT_MSG_EQ(+m_packets[0][2].GetTimeToLive(), 254, "Forwarded time to live");
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_queuedMessages.size(), 0, "Messages left in the queue");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the packing of the queued messages into packets
+ */
+class OlsrPacketPackingTestCase : public TestCase
+{
+  public:
+    OlsrPacketPackingTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Queues a MID message.
+     * \param protocol The protocol queuing the message.
+     * \param interfaces The number of interface addresses of the message.
+     */
+    void QueueMid(Ptr<RoutingProtocol> protocol, uint32_t interfaces);
+    /**
+     * Records the messages of a sent packet.
+     * \param header The packet header.
+     * \param messages The messages of the packet.
+     */
+    void PacketSent(const PacketHeader& header, const MessageList& messages);
+    /**
+     * Records the size of a sent packet.
+     * \param size The size of the packet.
+     * \param maxSize The largest packet fitting the MTU.
+     */
+    void PacketPacked(uint32_t size, uint32_t maxSize);
+
+    std::vector<uint32_t> m_messages; //!< Number of messages of the sent packets.
+    std::vector<uint32_t> m_sizes;    //!< Size of the sent packets.
+};
+
+OlsrPacketPackingTestCase::OlsrPacketPackingTestCase()
+    : TestCase("Check the packing of the queued OLSR messages into packets")
+{
+}
+
+void
+OlsrPacketPackingTestCase::QueueMid(Ptr<RoutingProtocol> protocol, uint32_t interfaces)
+{
+    olsr::MessageHeader msg;
+    for (uint32_t i = 0; i < interfaces; i++)
+    {
+        msg.GetMid().interfaceAddresses.emplace_back(Ipv4Address(0x0a010000 + i));
+    }
+    msg.SetOriginatorAddress(Ipv4Address("10.0.0.1"));
+    msg.SetVTime(Seconds(15));
+    msg.SetTimeToLive(255);
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(msg);
+    protocol->m_queuedMessages.push_back({packet, RoutingProtocol::MessagePriority::OWN});
+}
+
+void
+OlsrPacketPackingTestCase::PacketSent(const PacketHeader& header, const MessageList& messages)
+{
+    m_messages.push_back(messages.size());
+}
+
+void
+OlsrPacketPackingTestCase::PacketPacked(uint32_t size, uint32_t maxSize)
+{
+    m_sizes.push_back(size);
+}
+
+void
+OlsrPacketPackingTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    protocol->m_txPacketTrace.ConnectWithoutContext(
+        MakeCallback(&OlsrPacketPackingTestCase::PacketSent, this));
+    protocol->m_packetPackingTrace.ConnectWithoutContext(
+        MakeCallback(&OlsrPacketPackingTestCase::PacketPacked, this));
+
+    // Packets of up to six messages of 16 bytes
+    const uint32_t headerSize = olsr::PacketHeader().GetSerializedSize();
+    protocol->m_maxPacketSize = headerSize + 100;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        QueueMid(protocol, 1);
+    }
+    protocol->SendQueuedMessages();
+    NS_TEST_ASSERT_MSG_EQ(m_messages.size(), 2, "Messages not split over two packets");
+    NS_TEST_EXPECT_MSG_EQ(m_messages[0], 6, "First packet not full");
+    NS_TEST_EXPECT_MSG_EQ(m_messages[1], 4, "Messages missing from the second packet");
+    NS_TEST_EXPECT_MSG_EQ(m_sizes[0], headerSize + 96, "Size of the first packet");
+    NS_TEST_EXPECT_MSG_EQ(m_sizes[1], headerSize + 64, "Size of the second packet");
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_queuedMessages.size(), 0, "Messages left in the queue");
+    NS_TEST_EXPECT_MSG_EQ_TOL(protocol->GetPackingEfficiency(),
+                              double(2 * headerSize + 160) / (2 * (headerSize + 100)),
+                              1e-9,
+                              "Packing efficiency");
+
+    // However large the MTU, a packet carries at most 64 messages
+    m_messages.clear();
+    m_sizes.clear();
+    protocol->m_maxPacketSize = headerSize + 100 * 16;
+    for (uint32_t i = 0; i < 70; i++)
+    {
+        QueueMid(protocol, 1);
+    }
+    protocol->SendQueuedMessages();
+    NS_TEST_ASSERT_MSG_EQ(m_messages.size(), 2, "Message count not capped");
+    NS_TEST_EXPECT_MSG_EQ(m_messages[0], 64, "Message count cap");
+    NS_TEST_EXPECT_MSG_EQ(m_messages[1], 6, "Messages missing from the second packet");
+
+    // A message larger than the MTU is sent on its own, with a warning
+    m_messages.clear();
+    m_sizes.clear();
+    protocol->m_maxPacketSize = headerSize + 100;
+    QueueMid(protocol, 1);
+    QueueMid(protocol, 30);
+    QueueMid(protocol, 1);
+    protocol->SendQueuedMessages();
+    NS_TEST_ASSERT_MSG_EQ(m_messages.size(), 3, "Oversize message packed with others");
+    NS_TEST_EXPECT_MSG_EQ(m_messages[1], 1, "Oversize message packed with others");
+    NS_TEST_EXPECT_MSG_EQ(m_sizes[1], headerSize + 132, "Size of the oversize packet");
+    NS_TEST_EXPECT_MSG_EQ(m_messages[2], 1, "Message after the oversize one");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the advertisement and extrapolation of the node positions
+ */
+class OlsrPositionTestCase : public TestCase
+{
+  public:
+    OlsrPositionTestCase();
+    void DoRun() override;
+};
+
+OlsrPositionTestCase::OlsrPositionTestCase()
+    : TestCase("Check the suppression and extrapolation of the OLSR node positions")
+{
+}
+
+void
+OlsrPositionTestCase::DoRun()
+{
+    // Node 1 moves at 10 m/s along the x axis
+    Ptr<Node> senderNode = CreateObject<Node>();
+    Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel>();
+    mobility->SetPosition(Vector(100, 0, 0));
+    mobility->SetVelocity(Vector(10, 0, 0));
+    senderNode->AggregateObject(mobility);
+    Ptr<Node> receiverNode = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(senderNode);
+    internet.Install(receiverNode);
+
+    Ptr<RoutingProtocol> sender = CreateObject<RoutingProtocol>();
+    sender->SetIpv4(senderNode->GetObject<Ipv4>());
+    sender->m_mainAddress = Ipv4Address("10.0.0.1");
+    sender->m_positionOrigin = Vector(0, 0, 0);
+    sender->m_positionResolution = 0.1;
+    sender->m_deadReckoningThreshold = 5;
+    sender->m_deadReckoningRefreshInterval = Seconds(10);
+    Ptr<RoutingProtocol> receiver = CreateObject<RoutingProtocol>();
+    receiver->SetIpv4(receiverNode->GetObject<Ipv4>());
+    receiver->m_mainAddress = Ipv4Address("10.0.0.2");
+    receiver->m_positionOrigin = Vector(0, 0, 0);
+    receiver->m_positionResolution = 0.1;
+
+    // Node 1 advertises its position at 1 s, node 2 receives it 0.5 s later
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+    olsr::MessageHeader::PositionInfo positionInfo;
+    sender->FillPositionInfo(positionInfo, sender->m_helloMotion);
+    NS_TEST_ASSERT_MSG_EQ(positionInfo.HasPosition(), true, "First position suppressed");
+    Simulator::Stop(MilliSeconds(500));
+    Simulator::Run();
+    receiver->ProcessPositionInfo(Ipv4Address("10.0.0.1"), positionInfo, Seconds(100));
+    NS_TEST_EXPECT_MSG_EQ_TOL(receiver->GetNodePosition(Ipv4Address("10.0.0.1")).x,
+                              115.0,
+                              1e-6,
+                              "Position biased by the delay of the message");
+
+    // At a constant velocity, the extrapolated position stays accurate
+    Simulator::Stop(MilliSeconds(1500));
+    Simulator::Run();
+    positionInfo = olsr::MessageHeader::PositionInfo();
+    sender->FillPositionInfo(positionInfo, sender->m_helloMotion);
+    NS_TEST_EXPECT_MSG_EQ(positionInfo.HasPosition(), false, "Accurate position advertised");
+    receiver->ProcessPositionInfo(Ipv4Address("10.0.0.1"), positionInfo, Seconds(100));
+    NS_TEST_EXPECT_MSG_EQ_TOL(receiver->GetNodePosition(Ipv4Address("10.0.0.1")).x,
+                              130.0,
+                              1e-6,
+                              "Position not extrapolated");
+
+    // Once node 1 stops, the error grows until it exceeds the threshold
+    mobility->SetVelocity(Vector(0, 0, 0));
+    Simulator::Stop(MilliSeconds(400));
+    Simulator::Run();
+    positionInfo = olsr::MessageHeader::PositionInfo();
+    sender->FillPositionInfo(positionInfo, sender->m_helloMotion);
+    NS_TEST_EXPECT_MSG_EQ(positionInfo.HasPosition(), false, "Error below the threshold");
+    Simulator::Stop(MilliSeconds(600));
+    Simulator::Run();
+    positionInfo = olsr::MessageHeader::PositionInfo();
+    sender->FillPositionInfo(positionInfo, sender->m_helloMotion);
+    NS_TEST_EXPECT_MSG_EQ(positionInfo.HasPosition(), true, "Error beyond the threshold");
+    receiver->ProcessPositionInfo(Ipv4Address("10.0.0.1"), positionInfo, Seconds(100));
+    NS_TEST_EXPECT_MSG_EQ_TOL(receiver->GetNodePosition(Ipv4Address("10.0.0.1")).x,
+                              130.0,
+                              1e-6,
+                              "Position not updated");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the recomputation of the routing table as the nodes move
+ */
+class OlsrRouteRefreshTestCase : public TestCase
+{
+  public:
+    OlsrRouteRefreshTestCase();
+    void DoRun() override;
+};
+
+OlsrRouteRefreshTestCase::OlsrRouteRefreshTestCase()
+    : TestCase("Check the OLSR routing table recomputation on node movement")
+{
+}
+
+void
+OlsrRouteRefreshTestCase::DoRun()
+{
+    // The node moves at 20 m/s along the x axis
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel>();
+    mobility->SetPosition(Vector(0, 0, 0));
+    mobility->SetVelocity(Vector(20, 0, 0));
+    node->AggregateObject(mobility);
+    InternetStackHelper internet;
+    internet.Install(node);
+
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->SetIpv4(node->GetObject<Ipv4>());
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    protocol->m_routeRefreshDistance = 10;
+    protocol->RoutingTableComputation();
+    NS_TEST_ASSERT_MSG_EQ(protocol->m_routesTime, Seconds(0), "Routes not computed");
+
+    Simulator::Stop(MilliSeconds(250));
+    Simulator::Run();
+    protocol->RefreshRoutesOnMovement();
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_routesTime, Seconds(0), "Recomputed after 5 m");
+    Simulator::Stop(MilliSeconds(750));
+    Simulator::Run();
+    protocol->RefreshRoutesOnMovement();
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_routesTime, Seconds(1), "Not recomputed after 20 m");
+
+    // This node stops while the position of node 3 is extrapolated at 15 m/s
+    mobility->SetVelocity(Vector(0, 0, 0));
+    protocol->m_state.UpdateNodePosition(Ipv4Address("10.0.0.3"),
+                                         Vector(50, 0, 0),
+                                         Vector(15, 0, 0),
+                                         Simulator::Now(),
+                                         Seconds(100));
+    Simulator::Stop(MilliSeconds(500));
+    Simulator::Run();
+    protocol->RefreshRoutesOnMovement();
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_routesTime, Seconds(1), "Recomputed after 7.5 m");
+    Simulator::Stop(MilliSeconds(500));
+    Simulator::Run();
+    protocol->RefreshRoutesOnMovement();
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_routesTime, Seconds(2), "Not recomputed after 15 m");
+
+    Simulator::Destroy();
 }
 
 /**
@@ -190,6 +1259,17 @@ OlsrProtocolTestSuite::OlsrProtocolTestSuite()
     : TestSuite("routing-olsr", UNIT)
 {
     AddTestCase(new OlsrMprTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrDuplicateSetTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrRoutingTableTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrHnaRoutingTableTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrTcScopeTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrDifferentialTcTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrExpiryCoalescingTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrExpiryGenerationTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrMessageQueueTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrPacketPackingTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrPositionTestCase(), TestCase::QUICK);
+    AddTestCase(new OlsrRouteRefreshTestCase(), TestCase::QUICK);
 }
 
 static OlsrProtocolTestSuite g_olsrProtocolTestSuite; //!< Static variable for test initialization
@@ -26,6 +26,13 @@ void IntermediateRxCallback(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t i
 #endif
 }
 
+uint64_t g_controlBytes = 0; // 전송된 OLSR 제어 패킷의 총 바이트 수
+
+void OlsrTxCallback(const olsr::PacketHeader& header, const olsr::MessageList& messages)
+{
+    g_controlBytes += header.GetPacketLength();
+}
+
 /* void PrintNodePositions(NodeContainer c)
 {
     for (uint32_t i = 0; i < c.GetN(); ++i)
@@ -49,9 +56,17 @@ int main(int argc, char *argv[])
 
     std::string phyMode("DsssRate1Mbps");
 
+    std::string tcRedundancy("mpr-selectors"); // TC 메시지로 광고할 이웃
+    std::string fisheyeTtls(""); // TC 메시지 TTL 순환 (예: 2,4,255)
+
     CommandLine cmd(__FILE__);
+    cmd.AddValue("tcRedundancy", "mpr-selectors, mpr-selectors-and-mprs or all-neighbors", tcRedundancy);
+    cmd.AddValue("fisheyeTtls", "Comma-separated TC TTLs cycled through, e.g. 2,4,255", fisheyeTtls);
     cmd.Parse(argc, argv);
 
+    Config::SetDefault("ns3::olsr::RoutingProtocol::TcRedundancy", StringValue(tcRedundancy));
+    Config::SetDefault("ns3::olsr::RoutingProtocol::FisheyeTtls", StringValue(fisheyeTtls));
+
     std::random_device rd; // 랜덤 시드 설정
     RngSeedManager::SetSeed (rd());
     
@@ -102,6 +117,9 @@ int main(int argc, char *argv[])
     ipv4.SetBase("10.1.1.0", "255.255.255.0");
     Ipv4InterfaceContainer i = ipv4.Assign(devices);
 
+    // 제어 오버헤드 측정
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::olsr::RoutingProtocol/Tx", MakeCallback(&OlsrTxCallback));
+
     // Set up mobility model
     MobilityHelper mobility;
     Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable>();
@@ -231,6 +249,7 @@ int main(int argc, char *argv[])
 
         NS_LOG_UNCOND("Average Throughput = " << avgThroughput << " Mbps");
         NS_LOG_UNCOND("Average Packet Delivery Ratio = " << avgPacketDeliveryRatio << " %");
+        NS_LOG_UNCOND("Control Overhead = " << g_controlBytes / Simulator::Now().GetSeconds() << " bytes/s");
         
         if (validDelayCount > 0) {
             avgDelay /= validDelayCount;